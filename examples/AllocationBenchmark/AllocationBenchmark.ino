@@ -0,0 +1,108 @@
+// Counts how often a String payload is copied by the container operations. Every copy of a
+// String allocates a new heap buffer (the text is longer than any small string buffer), while
+// moves and in-place construction only hand over or create the one buffer the element needs.
+
+#include <ArrayList.h>
+#include <Deque.h>
+#include <HashMap.h>
+
+static const unsigned int COUNT = 16;
+
+struct Payload {
+	static unsigned long copies;
+	String text;
+	Payload() {}
+	Payload(const char* text): text(text) {}
+	Payload(const Payload& other): text(other.text) {
+		copies++;
+	}
+	Payload(Payload&& other): text(std::move(other.text)) {}
+	Payload& operator=(const Payload& other) {
+		text = other.text;
+		copies++;
+		return *this;
+	}
+	Payload& operator=(Payload&& other) {
+		text = std::move(other.text);
+		return *this;
+	}
+	bool operator==(const Payload& other) const {
+		return text == other.text;
+	}
+};
+
+unsigned long Payload::copies = 0;
+
+static const char* TEXT = "a payload which is too long for any small string buffer";
+
+static ArrayList<Payload, COUNT> list;
+static Deque<Payload, COUNT> deque;
+static HashMap<uint16_t, Payload, COUNT> map;
+
+static void report(const char* name) {
+	Serial.print(name);
+	Serial.print(" ");
+	Serial.println((float)Payload::copies / COUNT);
+	Payload::copies = 0;
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	Serial.println("Payload copies per operation");
+	const Payload payload(TEXT);
+	Payload::copies = 0;
+
+	list.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		list.add(payload);
+	}
+	report("ArrayList::add(const T&)     ");
+	list.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		list.add(Payload(TEXT));
+	}
+	report("ArrayList::add(T&&)          ");
+	list.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		list.emplace(TEXT);
+	}
+	report("ArrayList::emplace           ");
+
+	for (unsigned int i = 0; i < COUNT; i++) {
+		deque.push(payload);
+	}
+	report("Deque::push(const T&)        ");
+	Payload out;
+	for (unsigned int i = 0; i < COUNT; i++) {
+		deque.tryShift(out);
+	}
+	report("Deque::tryShift              ");
+	for (unsigned int i = 0; i < COUNT; i++) {
+		deque.push(Payload(TEXT));
+	}
+	report("Deque::push(T&&)             ");
+	deque.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		deque.emplaceFront(TEXT);
+	}
+	report("Deque::emplaceFront          ");
+
+	for (unsigned int i = 0; i < COUNT; i++) {
+		map.set(i, payload);
+	}
+	report("HashMap::set(K, const V&)    ");
+	map.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		map.set(i, Payload(TEXT));
+	}
+	report("HashMap::set(K, V&&)         ");
+	map.clear();
+	for (unsigned int i = 0; i < COUNT; i++) {
+		map.tryEmplace(i, TEXT);
+	}
+	report("HashMap::tryEmplace          ");
+}
+
+void loop() {
+}
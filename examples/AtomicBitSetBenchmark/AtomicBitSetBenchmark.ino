@@ -0,0 +1,71 @@
+// Measures what the atomic updates of AtomicBitSet cost compared to the plain BitSet, by timing
+// set/unset pairs, testAndSet/testAndClear pairs and draining whole words. The average time per
+// operation is printed in nanoseconds.
+
+#include <AtomicBitSet.h>
+#include <BitSet.h>
+
+static const unsigned int BITS = 256;
+static const unsigned int ROUNDS = 200;
+
+static BitSet<BITS> plain;
+static AtomicBitSet<BITS> atomic;
+static volatile unsigned int sink;
+
+static void print(const char* name, const unsigned long time, const unsigned long operations) {
+	Serial.print(name);
+	Serial.println(time * 1000 / operations);
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	Serial.println("Nanoseconds per operation");
+
+	unsigned long start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = 0; i < BITS; i++) {
+			plain.set(i);
+		}
+		for (unsigned int i = 0; i < BITS; i++) {
+			plain.unset(i);
+		}
+	}
+	print("BitSet set/unset                      ", micros() - start, 2UL * ROUNDS * BITS);
+
+	start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = 0; i < BITS; i++) {
+			atomic.set(i);
+		}
+		for (unsigned int i = 0; i < BITS; i++) {
+			atomic.unset(i);
+		}
+	}
+	print("AtomicBitSet set/unset                ", micros() - start, 2UL * ROUNDS * BITS);
+
+	start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = 0; i < BITS; i++) {
+			sink = atomic.testAndSet(i);
+		}
+		for (unsigned int i = 0; i < BITS; i++) {
+			sink = atomic.testAndClear(i);
+		}
+	}
+	print("AtomicBitSet testAndSet/testAndClear  ", micros() - start, 2UL * ROUNDS * BITS);
+
+	start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = round % 8; i < BITS; i += 8) {
+			atomic.set(i);
+		}
+		for (unsigned int w = 0; w < atomic.WORDS; w++) {
+			sink = atomic.fetchAndClearWord(w);
+		}
+	}
+	print("AtomicBitSet set + fetchAndClearWord  ", micros() - start, (unsigned long)ROUNDS * BITS / 8);
+}
+
+void loop() {
+}
@@ -0,0 +1,94 @@
+// Compares the identity hash (GenericHashComparer) with the mixing finalizer (MixingHashComparer)
+// for sequential, strided and random integer keys, once with a power of two capacity (masking)
+// and once with a prime capacity (division). For every combination a HashMap is filled to 75%,
+// and the average time in microseconds per add, per lookup of a present key and per lookup of an
+// absent key is printed.
+
+#include <HashMap.h>
+
+static const unsigned int COUNT = 192;
+static const unsigned int ROUNDS = 50;
+
+static uint32_t keys[COUNT];
+static uint32_t absent[COUNT];
+static volatile bool sink;
+
+enum Distribution {
+	SEQUENTIAL,
+	STRIDED,
+	RANDOM
+};
+
+static uint32_t randomKey() {
+	return ((uint32_t)random(0x10000) << 16) | (uint32_t)random(0x10000);
+}
+
+static void makeKeys(const Distribution distribution) {
+	randomSeed(1);
+	for (unsigned int i = 0; i < COUNT; i++) {
+		switch (distribution) {
+			case SEQUENTIAL:
+				keys[i] = 1000 + i;
+				absent[i] = 1000 + COUNT + i;
+				break;
+			case STRIDED:
+				keys[i] = i * 64;
+				absent[i] = (COUNT + i) * 64;
+				break;
+			default:
+				keys[i] = randomKey();
+				absent[i] = randomKey();
+				break;
+		}
+	}
+}
+
+template<unsigned int C, class H>
+void run(const char* name) {
+	static HashMap<uint32_t, uint16_t, C, H> map;
+	unsigned long add = 0;
+	unsigned long hit = 0;
+	unsigned long miss = 0;
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		map.clear();
+		unsigned long start = micros();
+		for (unsigned int i = 0; i < COUNT; i++) {
+			map.add(keys[i], i);
+		}
+		add += micros() - start;
+		start = micros();
+		for (unsigned int i = 0; i < COUNT; i++) {
+			sink = map.containsKey(keys[i]);
+		}
+		hit += micros() - start;
+		start = micros();
+		for (unsigned int i = 0; i < COUNT; i++) {
+			sink = map.containsKey(absent[i]);
+		}
+		miss += micros() - start;
+	}
+	Serial.print(name);
+	Serial.print("  add ");
+	Serial.print((float)add / (ROUNDS * COUNT));
+	Serial.print("  hit ");
+	Serial.print((float)hit / (ROUNDS * COUNT));
+	Serial.print("  miss ");
+	Serial.println((float)miss / (ROUNDS * COUNT));
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	const char* names[] = { "sequential", "strided", "random" };
+	for (unsigned int d = SEQUENTIAL; d <= RANDOM; d++) {
+		makeKeys((Distribution)d);
+		Serial.println(names[d]);
+		run<256, GenericHashComparer<uint32_t>>("  256 identity");
+		run<256, MixingHashComparer<GenericHashComparer<uint32_t>>>("  256 mixing  ");
+		run<257, GenericHashComparer<uint32_t>>("  257 identity");
+		run<257, MixingHashComparer<GenericHashComparer<uint32_t>>>("  257 mixing  ");
+	}
+}
+
+void loop() {
+}
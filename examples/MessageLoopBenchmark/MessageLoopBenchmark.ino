@@ -0,0 +1,87 @@
+// Measures how late MessageLoop runs its messages with many timers: TIMERS repeating messages with
+// periods between 10 ms and 1 s, each doing WORK_US microseconds of work, run for DURATION_MS.
+// Then the average, 99th percentile and worst lateness (the time between the due time of a message
+// and the start of its callback) and the jitter (standard deviation of the lateness) are printed.
+
+#include <MessageLoop.h>
+
+static const unsigned int TIMERS = 300;
+static const unsigned long WORK_US = 20;
+static const unsigned long DURATION_MS = 10000;
+static const unsigned int HISTOGRAM = 64;
+
+static MessageLoop<TIMERS> messageLoop;
+static unsigned long periods[TIMERS];
+static unsigned long due[TIMERS];
+static unsigned long histogram[HISTOGRAM];
+static unsigned long runs = 0;
+static unsigned long maxLate = 0;
+static double sumLate = 0;
+static double sumSquaresLate = 0;
+static unsigned long start;
+static bool reported = false;
+
+static int timer(unsigned int& index) {
+	const unsigned long now = millis();
+	const unsigned long late = now - due[index];
+	runs++;
+	sumLate += late;
+	sumSquaresLate += (double)late * late;
+	if (late > maxLate) {
+		maxLate = late;
+	}
+	histogram[late < HISTOGRAM ? late : HISTOGRAM - 1]++;
+	const unsigned long work = micros();
+	while (micros() - work < WORK_US) {
+	}
+	// the loop reschedules relative to the end of the callback
+	due[index] = millis() + periods[index];
+	return periods[index];
+}
+
+static unsigned long percentile(const unsigned int percent) {
+	const unsigned long target = runs * percent / 100;
+	unsigned long count = 0;
+	for (unsigned int i = 0; i < HISTOGRAM; i++) {
+		count += histogram[i];
+		if (count > target) {
+			return i;
+		}
+	}
+	return HISTOGRAM - 1;
+}
+
+static void report() {
+	const double mean = sumLate / runs;
+	const double variance = sumSquaresLate / runs - mean * mean;
+	Serial.print("runs ");
+	Serial.println(runs);
+	Serial.print("lateness ms  average ");
+	Serial.print(mean);
+	Serial.print("  p99 ");
+	Serial.print(percentile(99));
+	Serial.print("  max ");
+	Serial.print(maxLate);
+	Serial.print("  jitter ");
+	Serial.println(sqrt(variance > 0 ? variance : 0));
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	start = millis();
+	for (unsigned int i = 0; i < TIMERS; i++) {
+		periods[i] = 10 + (i * 37 % 50) * 20;
+		due[i] = start + periods[i];
+		messageLoop.post(timer, i, periods[i]);
+	}
+}
+
+void loop() {
+	if (millis() - start < DURATION_MS) {
+		messageLoop.processAll();
+	} else if (!reported) {
+		reported = true;
+		report();
+	}
+}
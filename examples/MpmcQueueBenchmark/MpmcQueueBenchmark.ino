@@ -0,0 +1,99 @@
+// Compares the throughput of MpmcQueue with a Deque guarded by a mutex, for 1 to MAX_THREADS
+// producer threads and as many consumer threads. Every run moves the same number of items; the
+// time in milliseconds and the throughput in items per millisecond are printed. This needs
+// threads, so it runs on ESP32 (where std::thread runs on FreeRTOS tasks on both cores), but not
+// on other boards, such as the ESP8266 or AVR, where it only prints a message.
+
+#include <Deque.h>
+#include <MpmcQueue.h>
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#include <mutex>
+#include <thread>
+
+static const unsigned int MAX_THREADS = 4;
+static const unsigned int ITEMS = 100000;
+
+class LockedDeque {
+public:
+	bool tryPush(const unsigned int value) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _deque.push(value);
+	}
+	bool tryPop(unsigned int& value) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _deque.tryShift(value);
+	}
+private:
+	std::mutex _mutex;
+	Deque<unsigned int, 256> _deque;
+};
+
+static MpmcQueue<unsigned int, 256> mpmc;
+static LockedDeque locked;
+
+template<class Q>
+void run(const char* name, Q& queue, const unsigned int threads) {
+	const unsigned int items = ITEMS / threads;
+	unsigned long sums[MAX_THREADS] = {};
+	std::thread producers[MAX_THREADS];
+	std::thread consumers[MAX_THREADS];
+	const unsigned long start = millis();
+	for (unsigned int t = 0; t < threads; t++) {
+		producers[t] = std::thread([&queue, items] {
+			for (unsigned int i = 1; i <= items; i++) {
+				while (!queue.tryPush(i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+		consumers[t] = std::thread([&queue, &sums, items, t] {
+			unsigned int value;
+			for (unsigned int i = 0; i < items; i++) {
+				while (!queue.tryPop(value)) {
+					std::this_thread::yield();
+				}
+				sums[t] += value;
+			}
+		});
+	}
+	unsigned long sum = 0;
+	for (unsigned int t = 0; t < threads; t++) {
+		producers[t].join();
+		consumers[t].join();
+		sum += sums[t];
+	}
+	const unsigned long time = millis() - start;
+	Serial.print(name);
+	Serial.print(threads);
+	Serial.print(" x ");
+	Serial.print(threads);
+	Serial.print(" threads  ");
+	Serial.print(time);
+	Serial.print(" ms  ");
+	Serial.print(time > 0 ? items * threads / time : 0);
+	Serial.println(sum == (unsigned long)threads * items * (items + 1) / 2 ? " items/ms" : " items/ms (checksum mismatch)");
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	for (unsigned int threads = 1; threads <= MAX_THREADS; threads++) {
+		run("MpmcQueue    ", mpmc, threads);
+		run("mutex Deque  ", locked, threads);
+	}
+}
+
+#else
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	Serial.println("MpmcQueueBenchmark needs a multi-core target with threads, such as the ESP32.");
+}
+
+#endif
+
+void loop() {
+}
@@ -0,0 +1,153 @@
+// Compares the probe lengths of LinearProbing and RobinHoodProbing at increasing load factors.
+// Every table is built with random keys and then churned by removing and adding keys, as a
+// routing table would be. The probe length of a lookup is the number of buckets it examines:
+// for a present key (hit) the distance from its home bucket to the bucket holding it plus one,
+// for an absent key (miss) every bucket up to the one which ends the probe. The average, 99th
+// percentile and worst probe lengths are printed, followed by the average lookup time in
+// microseconds, measured over all lookups at once.
+//
+// The probing tables are used directly (they are the storage of HashSet), since they report the
+// bucket of a key and whether a bucket is used, which is all it takes to count the probes.
+
+#include <HashSet.h>
+
+static const unsigned int CAPACITY = 256;
+static const unsigned int LOOKUPS = 256;
+static const unsigned int ROUNDS = 20;
+
+typedef MixingHashComparer<GenericHashComparer<uint32_t>> Hasher;
+
+static uint32_t keys[CAPACITY];
+static uint32_t absent[LOOKUPS];
+static uint16_t probes[LOOKUPS];
+static volatile unsigned int sink;
+
+static uint32_t randomKey() {
+	return ((uint32_t)random(0x10000) << 16) | (uint32_t)random(0x10000);
+}
+
+static unsigned int home(const uint32_t key) {
+	return HashBucket<CAPACITY>::of(Hasher::getHash(key));
+}
+
+static unsigned int distance(const unsigned int from, const unsigned int to) {
+	return (to + CAPACITY - from) % CAPACITY;
+}
+
+// Linear probing examines buckets until it finds the key or an empty bucket.
+template<class P>
+unsigned int missProbes(const P& table, const uint32_t key, const bool robinHood) {
+	unsigned int bucket = home(key);
+	for (unsigned int probe = 1; probe <= CAPACITY; probe++) {
+		if (!table.isUsed(bucket)) {
+			return probe;
+		}
+		// Robin Hood probing also stops at an entry which is closer to its own home than the probe
+		if (robinHood && distance(home(table[bucket]), bucket) + 1 < probe) {
+			return probe;
+		}
+		bucket = HashBucket<CAPACITY>::next(bucket);
+	}
+	return CAPACITY;
+}
+
+static void sortProbes() {
+	for (unsigned int i = 1; i < LOOKUPS; i++) {
+		const uint16_t value = probes[i];
+		unsigned int j = i;
+		for (; j > 0 && probes[j - 1] > value; j--) {
+			probes[j] = probes[j - 1];
+		}
+		probes[j] = value;
+	}
+}
+
+static void printProbes(const char* label) {
+	unsigned long sum = 0;
+	for (unsigned int i = 0; i < LOOKUPS; i++) {
+		sum += probes[i];
+	}
+	sortProbes();
+	Serial.print(label);
+	Serial.print((float)sum / LOOKUPS);
+	Serial.print(" / ");
+	Serial.print(probes[LOOKUPS * 99 / 100]);
+	Serial.print(" / ");
+	Serial.print(probes[LOOKUPS - 1]);
+}
+
+template<class P>
+float lookupTime(const P& table, const uint32_t* lookups) {
+	const unsigned long start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = 0; i < LOOKUPS; i++) {
+			sink = table.find(lookups[i]);
+		}
+	}
+	return (float)(micros() - start) / (ROUNDS * LOOKUPS);
+}
+
+template<class P>
+void add(P& table, const uint32_t key) {
+	bool inserted;
+	const unsigned int bucket = table.insert(key, inserted);
+	if (inserted) {
+		table.construct(bucket, key);
+	}
+}
+
+template<class P>
+void run(P& table, const char* name, const bool robinHood, const unsigned int percent) {
+	const unsigned int count = CAPACITY * percent / 100;
+	randomSeed(percent);
+	table.clear();
+	for (unsigned int i = 0; i < count; i++) {
+		keys[i] = randomKey();
+		add(table, keys[i]);
+	}
+	for (unsigned int i = 0; i < count * 4; i++) {
+		const unsigned int victim = random(count);
+		const unsigned int bucket = table.find(keys[victim]);
+		if (bucket < CAPACITY) {
+			table.remove(bucket);
+		}
+		keys[victim] = randomKey();
+		add(table, keys[victim]);
+	}
+	uint32_t present[LOOKUPS];
+	for (unsigned int i = 0; i < LOOKUPS; i++) {
+		present[i] = keys[i % count];
+		probes[i] = distance(home(present[i]), table.find(present[i])) + 1;
+	}
+	Serial.print(name);
+	Serial.print(percent);
+	printProbes("%  hit ");
+	Serial.print("  ");
+	Serial.print(lookupTime(table, present));
+	Serial.print(" us");
+	for (unsigned int i = 0; i < LOOKUPS; i++) {
+		absent[i] = randomKey();
+		probes[i] = missProbes(table, absent[i], robinHood);
+	}
+	printProbes("  miss ");
+	Serial.print("  ");
+	Serial.print(lookupTime(table, absent));
+	Serial.println(" us");
+}
+
+static LinearProbing<uint32_t, uint32_t, CAPACITY, Hasher> linear;
+static RobinHoodProbing<uint32_t, uint32_t, CAPACITY, Hasher> robinHood;
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	Serial.println("Probe length average / p99 / max, then average lookup time");
+	const unsigned int loads[] = { 50, 75, 85, 90, 95 };
+	for (unsigned int i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+		run(linear, "Linear    ", false, loads[i]);
+		run(robinHood, "RobinHood ", true, loads[i]);
+	}
+}
+
+void loop() {
+}
@@ -0,0 +1,72 @@
+// Compares the String hash comparers on a set of MQTT-like topic paths which share long prefixes.
+// For every comparer it prints how many keys share their full hash with an earlier key, how many
+// land in an already used bucket of a 256-bucket table, and the average hashing time per key in
+// microseconds.
+
+#include <HashComparer.h>
+
+static const unsigned int COUNT = 200;
+static const unsigned int BUCKETS = 256;
+static const unsigned int ROUNDS = 20;
+
+static String keys[COUNT];
+static unsigned int hashes[COUNT];
+static bool used[BUCKETS];
+static volatile unsigned int sink;
+
+static void makeKeys() {
+	const char* measurements[] = { "temperature", "humidity", "pressure", "battery", "rssi" };
+	for (unsigned int i = 0; i < COUNT; i++) {
+		keys[i] = String("building/north-wing/floor-") + String(i / 50) + String("/room-") + String(i / 5 % 10) + String("/sensors/") + measurements[i % 5];
+	}
+}
+
+template<class H>
+void run(const char* name) {
+	unsigned long start = micros();
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (unsigned int i = 0; i < COUNT; i++) {
+			sink = H::getHash(keys[i]);
+		}
+	}
+	const unsigned long time = micros() - start;
+	unsigned int sameHash = 0;
+	unsigned int sameBucket = 0;
+	memset(used, 0, sizeof(used));
+	for (unsigned int i = 0; i < COUNT; i++) {
+		hashes[i] = H::getHash(keys[i]);
+		for (unsigned int j = 0; j < i; j++) {
+			if (hashes[j] == hashes[i]) {
+				sameHash++;
+				break;
+			}
+		}
+		const unsigned int bucket = hashes[i] % BUCKETS;
+		if (used[bucket]) {
+			sameBucket++;
+		}
+		used[bucket] = true;
+	}
+	Serial.print(name);
+	Serial.print("  same hash ");
+	Serial.print(sameHash);
+	Serial.print("  same bucket ");
+	Serial.print(sameBucket);
+	Serial.print("  us/key ");
+	Serial.println((float)time / (ROUNDS * COUNT));
+}
+
+void setup() {
+	Serial.begin(115200);
+	Serial.println();
+	makeKeys();
+	Serial.print("Key example: ");
+	Serial.println(keys[COUNT - 1]);
+	run<StringHashComparer>("StringHashComparer                 ");
+	run<StringFullHashComparer<>>("StringFullHashComparer             ");
+	run<StringIgnoreCaseHashComparer>("StringIgnoreCaseHashComparer       ");
+	run<StringIgnoreCaseFullHashComparer<>>("StringIgnoreCaseFullHashComparer   ");
+}
+
+void loop() {
+}
@@ -22,8 +22,11 @@
 #define _ArrayList_H
 
 #include <Arduino.h>
+#include <utility>
 #include "CollectionError.h"
 #include "Comparer.h"
+#include "IndexType.h"
+#include "RawArray.h"
 #include "iterator_tpl.h"
 
 template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
@@ -34,57 +37,110 @@ private:
 		inline void next(const ArrayList* set) { 
 			_index++;
 			if (_index >= set->size()) {
-				index = C;
+				_index = C;
 			}
 		}
+		// C marks the position past either end, so stepping back from end() reaches the last element
+		// and stepping back from the first one reaches the marker, as reverse iteration expects.
 		inline void prev(const ArrayList* set) { 
-			if (_index > 0) { 
+			if (_index == C) {
+				_index = set->size() > 0 ? set->size() - 1 : C;
+			} else if (_index > 0) { 
 				_index--;
+			} else {
+				_index = C;
 			}
 		}
 		inline void begin(const ArrayList* set) {
-			_index = 0; 
+			_index = set->size() > 0 ? 0 : C; 
 		}
 		inline void end(const ArrayList* set) { 
 			_index = C; 
 		}
-		inline bool get(ArrayList* set) { 
+		inline T get(ArrayList* set) { 
 			return set->_data[_index];
 		}
-		inline const bool get(const ArrayList* set) { 
+		inline const T get(const ArrayList* set) { 
 			return set->_data[_index];
 		}
 		inline bool cmp(const IteratorState& s) const { 
 			return _index != s._index; 
 		}
 	private:
-		unsigned int _index;
+		IndexType<C> _index;
 	};
 public:
+	static constexpr size_t footprint();
+	static constexpr size_t overhead();
+	ArrayList();
+	ArrayList(const ArrayList& other);
+	~ArrayList();
+	ArrayList& operator=(const ArrayList& other);
 	unsigned int size() const;
 	bool isFull() const;
 	T& operator[](unsigned int index);
-	unsigned int add(const T value);
-	void insert(const T value, unsigned int index);
+	unsigned int add(const T& value);
+	unsigned int add(T&& value);
+	template<typename... Args>
+	unsigned int emplace(Args&&... args);
+	void insert(const T& value, unsigned int index);
+	void insert(T&& value, unsigned int index);
 	void removeAt(unsigned int index);
 	template<Comparer<T> S = GenericComparer<T>>
-	void remove(const T value);
+	void remove(const T& value);
 	template<Comparer<T> S = GenericComparer<T>>
 	void sort();
 	template<Comparer<T> S = GenericComparer<T>>
-	int indexOf(const T value);
+	int indexOf(const T& value);
 	void clear();
 	SETUP_ITERATORS(ArrayList, T, IteratorState);
 	SETUP_REVERSE_ITERATORS(ArrayList, T, IteratorState);
 private:
-	T _data[C];
-	unsigned int _size;
+	RawArray<T, C> _data;
+	IndexType<C> _size;
 	template<Comparer<T> S>
-	void quickSort(const unsigned int left, const unsigned int right);
+	void quickSort(const int left, const int right);
 	bool assertValidRange(unsigned int index) const;
 	bool assertNotFull() const;
+	bool makeRoom(unsigned int index);
 };
 
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t ArrayList<T, C, E>::footprint() {
+	return sizeof(ArrayList);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t ArrayList<T, C, E>::overhead() {
+	return sizeof(ArrayList) - sizeof(T) * C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+ArrayList<T, C, E>::ArrayList(): _size(0) {
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+ArrayList<T, C, E>::ArrayList(const ArrayList& other): _size(0) {
+	*this = other;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+ArrayList<T, C, E>::~ArrayList() {
+	clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+ArrayList<T, C, E>& ArrayList<T, C, E>::operator=(const ArrayList& other) {
+	if (this != &other) {
+		clear();
+		while (_size < other._size) {
+			_data.construct(_size, other._data[_size]);
+			_size++;
+		}
+	}
+	return *this;
+}
+
 template<typename T, unsigned int C, CollectionErrorHandler E>
 inline unsigned int ArrayList<T, C, E>::size() const {
 	return _size;
@@ -102,56 +158,73 @@ T& ArrayList<T, C, E>::operator[](unsigned int index) {
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
-unsigned int ArrayList<T, C, E>::add(const T value) {
+unsigned int ArrayList<T, C, E>::add(const T& value) {
 	if (assertNotFull()) {
 		unsigned int index = _size++;
-		_data[index] = value;
+		_data.construct(index, value);
 		return index;
 	}
 	return -1;
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
-void ArrayList<T, C, E>::insert(const T value, unsigned int index) {
+unsigned int ArrayList<T, C, E>::add(T&& value) {
 	if (assertNotFull()) {
-		if (index > _size) {
-			E(CollectionError::OutOfBound);
-			return;
-		}
-		for (unsigned int i = _size; i > index; i--) {
-			_data[i] = _data[i - 1];
-		}
-		_data[index] = value;
+		unsigned int index = _size++;
+		_data.construct(index, std::move(value));
+		return index;
+	}
+	return -1;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+template<typename... Args>
+unsigned int ArrayList<T, C, E>::emplace(Args&&... args) {
+	if (assertNotFull()) {
+		unsigned int index = _size++;
+		_data.construct(index, std::forward<Args>(args)...);
+		return index;
+	}
+	return -1;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void ArrayList<T, C, E>::insert(const T& value, unsigned int index) {
+	if (makeRoom(index)) {
+		_data.construct(index, value);
+	}
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void ArrayList<T, C, E>::insert(T&& value, unsigned int index) {
+	if (makeRoom(index)) {
+		_data.construct(index, std::move(value));
 	}
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 void ArrayList<T, C, E>::removeAt(unsigned int index) {
 	if (assertValidRange(index)) {
+		_data.destroy(index);
+		_data.closeGap(index, _size);
 		_size--;
-		for (unsigned int i = index; index < _size; i++) {
-			_data[i] = _data[i + 1];
-		}
-		_data[_size] == T();
 	}
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 template<Comparer<T> S>
-void ArrayList<T, C, E>::remove(const T value) {
+void ArrayList<T, C, E>::remove(const T& value) {
 	const unsigned int oldSize = _size;
 	unsigned int offset = 0;
-	for (unsigned int i = 0; i < _size; i--) {
+	for (unsigned int i = 0; i < oldSize; i++) {
 		if (S(value, _data[i]) == 0) {
 			offset++;
-			_size--;
 		} else if (offset > 0) {
-			_data[i - offset] = _data[i];
+			_data[i - offset] = std::move(_data[i]);
 		}
 	}
-	for (unsigned int i = _size; i < oldSize; i++) {
-		_data[i] = T();
-	}
+	_size = oldSize - offset;
+	_data.destroy(_size, oldSize);
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
@@ -164,10 +237,10 @@ void ArrayList<T, C, E>::sort() {
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 template<Comparer<T> S>
-void ArrayList<T, C, E>::quickSort(const unsigned int left, const unsigned int right) {
-	const unsigned int mid = (left + right) / 2;
-	unsigned int i = left;
-	unsigned int j = right;
+void ArrayList<T, C, E>::quickSort(const int left, const int right) {
+	int mid = (left + right) / 2;
+	int i = left;
+	int j = right;
 	while (i <= j) {
 		while (S(_data[i], _data[mid]) < 0) {
 			i++;
@@ -176,9 +249,15 @@ void ArrayList<T, C, E>::quickSort(const unsigned int left, const unsigned int r
 			j--;
 		}
 		if (i <= j) {
-			T tmp = _data[i];
-			_data[i++] = _data[j];
-			_data[j--] = tmp;
+			if (i != j) {
+				// the pivot is not copied, so follow it when it gets swapped
+				T tmp = std::move(_data[i]);
+				_data[i] = std::move(_data[j]);
+				_data[j] = std::move(tmp);
+				mid = mid == i ? j : mid == j ? i : mid;
+			}
+			i++;
+			j--;
 		}
 	};
 	if (left < j) {
@@ -191,8 +270,8 @@ void ArrayList<T, C, E>::quickSort(const unsigned int left, const unsigned int r
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 template<Comparer<T> S>
-int ArrayList<T, C, E>::indexOf(const T value) {
-	for (int i = 0; i < _size; i++) {
+int ArrayList<T, C, E>::indexOf(const T& value) {
+	for (int i = 0; i < (int)_size; i++) {
 		if (S(value, _data[i]) == 0) {
 			return i;
 		}
@@ -202,10 +281,8 @@ int ArrayList<T, C, E>::indexOf(const T value) {
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 void ArrayList<T, C, E>::clear() {
-	while (_size > 0) {
-		_size--;
-		_data[_size] = T();
-	}
+	_data.destroy(0, _size);
+	_size = 0;
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
@@ -226,4 +303,18 @@ bool ArrayList<T, C, E>::assertNotFull() const {
 	return false;
 }
 
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool ArrayList<T, C, E>::makeRoom(unsigned int index) {
+	if (assertNotFull()) {
+		if (index > _size) {
+			E(CollectionError::OutOfBound);
+			return false;
+		}
+		_data.openGap(index, _size);
+		_size++;
+		return true;
+	}
+	return false;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _AtomicBitSet_H
+#define _AtomicBitSet_H
+
+#include <Arduino.h>
+#include "CollectionError.h"
+
+// A BitSet whose bits may be changed concurrently from interrupts or other cores.
+// All updates are single atomic read-modify-write operations on the word holding the bit.
+template<unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class AtomicBitSet {
+public:
+	static constexpr unsigned int WORD_BITS = sizeof(unsigned int)*8;
+	static constexpr unsigned int WORDS = (C + WORD_BITS - 1) / WORD_BITS;
+	AtomicBitSet();
+	static constexpr size_t footprint();
+	unsigned int size() const;
+	bool operator [](const unsigned int i) const;
+	void set(const unsigned int i);
+	void unset(const unsigned int i);
+	bool testAndSet(const unsigned int i);
+	bool testAndClear(const unsigned int i);
+	unsigned int fetchAndClearWord(const unsigned int word);
+	void clear();
+private:
+	static constexpr unsigned int MASK = WORD_BITS - 1;
+	unsigned int _data[WORDS];
+	bool assertValidRange(const unsigned int i) const;
+};
+
+template<unsigned int C, CollectionErrorHandler E>
+AtomicBitSet<C, E>::AtomicBitSet() {
+	clear();
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+constexpr size_t AtomicBitSet<C, E>::footprint() {
+	return sizeof(AtomicBitSet);
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int AtomicBitSet<C, E>::size() const {
+	return C;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline bool AtomicBitSet<C, E>::assertValidRange(const unsigned int i) const {
+	if (i < C) {
+		return true;
+	}
+	E(CollectionError::OutOfBound);
+	return false;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline bool AtomicBitSet<C, E>::operator[](const unsigned int i) const {
+	if (assertValidRange(i)) {
+		return (__atomic_load_n(&_data[i / WORD_BITS], __ATOMIC_ACQUIRE) & (1U << (i & MASK))) != 0;
+	}
+	return false;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline void AtomicBitSet<C, E>::set(const unsigned int i) {
+	if (assertValidRange(i)) {
+		__atomic_fetch_or(&_data[i / WORD_BITS], 1U << (i & MASK), __ATOMIC_ACQ_REL);
+	}
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline void AtomicBitSet<C, E>::unset(const unsigned int i) {
+	if (assertValidRange(i)) {
+		__atomic_fetch_and(&_data[i / WORD_BITS], ~(1U << (i & MASK)), __ATOMIC_ACQ_REL);
+	}
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline bool AtomicBitSet<C, E>::testAndSet(const unsigned int i) {
+	if (assertValidRange(i)) {
+		const unsigned int bit = 1U << (i & MASK);
+		return (__atomic_fetch_or(&_data[i / WORD_BITS], bit, __ATOMIC_ACQ_REL) & bit) != 0;
+	}
+	return false;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline bool AtomicBitSet<C, E>::testAndClear(const unsigned int i) {
+	if (assertValidRange(i)) {
+		const unsigned int bit = 1U << (i & MASK);
+		return (__atomic_fetch_and(&_data[i / WORD_BITS], ~bit, __ATOMIC_ACQ_REL) & bit) != 0;
+	}
+	return false;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int AtomicBitSet<C, E>::fetchAndClearWord(const unsigned int word) {
+	if (word < WORDS) {
+		return __atomic_exchange_n(&_data[word], 0U, __ATOMIC_ACQ_REL);
+	}
+	E(CollectionError::OutOfBound);
+	return 0;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void AtomicBitSet<C, E>::clear() {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		__atomic_store_n(&_data[w], 0U, __ATOMIC_RELEASE);
+	}
+}
+
+#endif
\ No newline at end of file
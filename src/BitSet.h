@@ -22,9 +22,14 @@
 #define _BitSet_H
 
 #include <Arduino.h>
+#include <type_traits>
 #include "CollectionError.h"
+#include "IndexType.h"
 #include "iterator_tpl.h"
 
+template<unsigned int C, CollectionErrorHandler E>
+class RankSelectBitSet;
+
 template<unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
 class BitSet {
 private:
@@ -56,23 +61,78 @@ private:
 			return _index != s._index; 
 		}
 	private:
-		unsigned int _index;
+		IndexType<C> _index;
+	};
+	class SetBitIteratorState {
+	public:
+		inline void next(const BitSet* set) { 
+			_index = set->findNextSet(_index);
+		}
+		inline void begin(const BitSet* set) {
+			_index = set->findFirstSet(); 
+		}
+		inline void end(const BitSet* set) { 
+			_index = C; 
+		}
+		inline unsigned int get(const BitSet* set) { 
+			return _index;
+		}
+		inline bool cmp(const SetBitIteratorState& s) const { 
+			return _index != s._index; 
+		}
+	private:
+		IndexType<C> _index;
 	};
 public:
+	typedef iterator_tpl::const_iterator<BitSet, unsigned int, SetBitIteratorState> set_bit_iterator;
+	class SetBits {
+	public:
+		SetBits(const BitSet* set) : _set(set) {}
+		set_bit_iterator begin() const { return set_bit_iterator::begin(_set); }
+		set_bit_iterator end() const { return set_bit_iterator::end(_set); }
+	private:
+		const BitSet* _set;
+	};
+
+	static constexpr size_t footprint();
 	unsigned int size() const;
 	bool operator [](const unsigned int i) const;
 	void set(const unsigned int i);
 	void unset(const unsigned int i);
 	void clear();
+	void setRange(const unsigned int from, const unsigned int to);
+	void clearRange(const unsigned int from, const unsigned int to);
+	unsigned int count() const;
+	unsigned int findFirstSet() const;
+	unsigned int findNextSet(const unsigned int i) const;
+	unsigned int findFirstClear() const;
+	BitSet& operator &=(const BitSet& other);
+	BitSet& operator |=(const BitSet& other);
+	BitSet& operator ^=(const BitSet& other);
+	BitSet& andNot(const BitSet& other);
+	SetBits setBits() const;
 	SETUP_ITERATORS(BitSet, bool, IteratorState);
 	SETUP_REVERSE_ITERATORS(BitSet, bool, IteratorState);
 private:
-	static constexpr unsigned int BITS = sizeof(unsigned int)*8;
+	friend class RankSelectBitSet<C, E>;
+	// small sets use a single word just wide enough, larger ones the native word
+	typedef typename std::conditional<(C <= 8), uint8_t, typename std::conditional<(C <= 16), uint16_t, unsigned int>::type>::type Word;
+	static constexpr unsigned int BITS = sizeof(Word)*8;
 	static constexpr unsigned int MASK = BITS - 1;
-	unsigned int _data[(C+MASK)/BITS];
+	static constexpr unsigned int WORDS = (C+MASK)/BITS;
+	static constexpr Word ALL = (Word)~(Word)0;
+	// bits at and above C are always kept clear
+	Word _data[WORDS];
 	bool assertValidRange(const unsigned int i) const;
+	bool assertValidRange(const unsigned int from, const unsigned int to) const;
+	unsigned int scanSet(const unsigned int from) const;
 };
 
+template<unsigned int C, CollectionErrorHandler E>
+constexpr size_t BitSet<C, E>::footprint() {
+	return sizeof(BitSet);
+}
+
 template<unsigned int C, CollectionErrorHandler E>
 inline unsigned int BitSet<C, E>::size() const {
 	return C;
@@ -87,10 +147,19 @@ inline bool BitSet<C, E>::assertValidRange(const unsigned int i) const {
 	return false;
 }
 
+template<unsigned int C, CollectionErrorHandler E>
+inline bool BitSet<C, E>::assertValidRange(const unsigned int from, const unsigned int to) const {
+	if (from <= to && to <= C) {
+		return true;
+	}
+	E(CollectionError::OutOfBound);
+	return false;
+}
+
 template<unsigned int C, CollectionErrorHandler E>
 inline bool BitSet<C, E>::operator[](const unsigned int i) const {
 	if (assertValidRange(i)) {
-		return (_data[i / BITS] & (1 << (i & MASK))) > 0;
+		return (_data[i / BITS] & ((Word)1 << (i & MASK))) != 0;
 	}
 	return false;
 }
@@ -98,14 +167,14 @@ inline bool BitSet<C, E>::operator[](const unsigned int i) const {
 template<unsigned int C, CollectionErrorHandler E>
 void BitSet<C, E>::set(const unsigned int i) {
 	if (assertValidRange(i)) {
-		_data[i / BITS] |= (1 << (i & MASK));
+		_data[i / BITS] |= (Word)1 << (i & MASK);
 	}
 }
 
 template<unsigned int C, CollectionErrorHandler E>
 void BitSet<C, E>::unset(const unsigned int i) {
 	if (assertValidRange(i)) {
-		_data[i / BITS] &= ~(1 << (i & MASK));
+		_data[i / BITS] &= ~((Word)1 << (i & MASK));
 	}
 }
 
@@ -114,4 +183,128 @@ void BitSet<C, E>::clear() {
 	memset(&_data[0], 0, sizeof(_data));
 }
 
+template<unsigned int C, CollectionErrorHandler E>
+void BitSet<C, E>::setRange(const unsigned int from, const unsigned int to) {
+	if (!assertValidRange(from, to) || from == to) {
+		return;
+	}
+	unsigned int w = from / BITS;
+	const unsigned int last = (to - 1) / BITS;
+	const Word head = (Word)(ALL << (from & MASK));
+	const Word tail = (Word)(ALL >> (MASK - ((to - 1) & MASK)));
+	if (w == last) {
+		_data[w] |= head & tail;
+		return;
+	}
+	_data[w++] |= head;
+	while (w < last) {
+		_data[w++] = ALL;
+	}
+	_data[last] |= tail;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void BitSet<C, E>::clearRange(const unsigned int from, const unsigned int to) {
+	if (!assertValidRange(from, to) || from == to) {
+		return;
+	}
+	unsigned int w = from / BITS;
+	const unsigned int last = (to - 1) / BITS;
+	const Word head = (Word)(ALL << (from & MASK));
+	const Word tail = (Word)(ALL >> (MASK - ((to - 1) & MASK)));
+	if (w == last) {
+		_data[w] &= ~(head & tail);
+		return;
+	}
+	_data[w++] &= ~head;
+	while (w < last) {
+		_data[w++] = 0;
+	}
+	_data[last] &= ~tail;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+unsigned int BitSet<C, E>::count() const {
+	unsigned int result = 0;
+	for (unsigned int w = 0; w < WORDS; w++) {
+		result += __builtin_popcount(_data[w]);
+	}
+	return result;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+unsigned int BitSet<C, E>::scanSet(const unsigned int from) const {
+	unsigned int w = from / BITS;
+	Word bits = _data[w] & (Word)(ALL << (from & MASK));
+	while (!bits) {
+		if (++w >= WORDS) {
+			return C;
+		}
+		bits = _data[w];
+	}
+	return w * BITS + __builtin_ctz(bits);
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int BitSet<C, E>::findFirstSet() const {
+	return scanSet(0);
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int BitSet<C, E>::findNextSet(const unsigned int i) const {
+	if (i + 1 >= C) {
+		return C;
+	}
+	return scanSet(i + 1);
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+unsigned int BitSet<C, E>::findFirstClear() const {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		const Word bits = ~_data[w];
+		if (bits) {
+			const unsigned int i = w * BITS + __builtin_ctz(bits);
+			return i < C ? i : C;
+		}
+	}
+	return C;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+BitSet<C, E>& BitSet<C, E>::operator&=(const BitSet& other) {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		_data[w] &= other._data[w];
+	}
+	return *this;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+BitSet<C, E>& BitSet<C, E>::operator|=(const BitSet& other) {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		_data[w] |= other._data[w];
+	}
+	return *this;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+BitSet<C, E>& BitSet<C, E>::operator^=(const BitSet& other) {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		_data[w] ^= other._data[w];
+	}
+	return *this;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+BitSet<C, E>& BitSet<C, E>::andNot(const BitSet& other) {
+	for (unsigned int w = 0; w < WORDS; w++) {
+		_data[w] &= ~other._data[w];
+	}
+	return *this;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline typename BitSet<C, E>::SetBits BitSet<C, E>::setBits() const {
+	return SetBits(this);
+}
+
 #endif
\ No newline at end of file
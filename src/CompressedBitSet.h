@@ -0,0 +1,710 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _CompressedBitSet_H
+#define _CompressedBitSet_H
+
+#include <Arduino.h>
+#include "CollectionError.h"
+#include "IndexType.h"
+#include "iterator_tpl.h"
+
+// The bits are split into chunks of B bits. Each chunk is stored in a shared pool of S 16-bit words,
+// either as a sorted array of offsets, a plain bitmap or a list of runs, whichever is smallest.
+template<unsigned int C, unsigned int S, unsigned int B = 4096, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class CompressedBitSet {
+	static_assert(B >= 16 && B <= 65536 && (B & (B - 1)) == 0, "chunk size must be a power of two between 16 and 65536");
+private:
+	class SetBitIteratorState {
+	public:
+		inline void next(const CompressedBitSet* set) { 
+			_index = set->findNextSet(_index);
+		}
+		inline void begin(const CompressedBitSet* set) {
+			_index = set->findFirstSet(); 
+		}
+		inline void end(const CompressedBitSet* set) { 
+			_index = C; 
+		}
+		inline unsigned int get(const CompressedBitSet* set) { 
+			return _index;
+		}
+		inline bool cmp(const SetBitIteratorState& s) const { 
+			return _index != s._index; 
+		}
+	private:
+		IndexType<C> _index;
+	};
+	class Runs {
+	public:
+		Runs(const uint8_t kind, const uint16_t* data, const unsigned int length): _kind(kind), _data(data), _length(length), _position(0) {}
+		bool next(uint32_t& start, uint32_t& end);
+	private:
+		uint8_t _kind;
+		const uint16_t* _data;
+		unsigned int _length;
+		uint32_t _position;
+	};
+public:
+	typedef iterator_tpl::const_iterator<CompressedBitSet, unsigned int, SetBitIteratorState> set_bit_iterator;
+	class SetBits {
+	public:
+		SetBits(const CompressedBitSet* set) : _set(set) {}
+		set_bit_iterator begin() const { return set_bit_iterator::begin(_set); }
+		set_bit_iterator end() const { return set_bit_iterator::end(_set); }
+	private:
+		const CompressedBitSet* _set;
+	};
+	CompressedBitSet();
+	static constexpr size_t footprint();
+	unsigned int size() const;
+	unsigned int count() const;
+	unsigned int usedWords() const;
+	bool operator [](const unsigned int i) const;
+	void set(const unsigned int i);
+	void unset(const unsigned int i);
+	void clear();
+	void setRange(const unsigned int from, const unsigned int to);
+	void clearRange(const unsigned int from, const unsigned int to);
+	unsigned int findFirstSet() const;
+	unsigned int findNextSet(const unsigned int i) const;
+	CompressedBitSet& operator |=(const CompressedBitSet& other);
+	CompressedBitSet& operator &=(const CompressedBitSet& other);
+	CompressedBitSet& andNot(const CompressedBitSet& other);
+	void optimize();
+	SetBits setBits() const;
+private:
+	static constexpr uint8_t ARRAY = 0;
+	static constexpr uint8_t BITMAP = 1;
+	static constexpr uint8_t RUN = 2;
+	static constexpr uint8_t OR = 0;
+	static constexpr uint8_t AND = 1;
+	static constexpr uint8_t AND_NOT = 2;
+	static constexpr unsigned int CHUNKS = (C + B - 1) / B;
+	// a bitmap takes B/16 words, so an array never grows beyond that many entries
+	static constexpr unsigned int BITMAP_WORDS = B / 16;
+	uint16_t _pool[S];
+	IndexType<S> _start[CHUNKS + 1];
+	uint8_t _kind[CHUNKS];
+	IndexType<B> _count[CHUNKS];
+	bool assertValidRange(const unsigned int i) const;
+	bool assertValidRange(const unsigned int from, const unsigned int to) const;
+	unsigned int length(const unsigned int c) const;
+	Runs runs(const unsigned int c) const;
+	uint32_t nextInChunk(const unsigned int c, const uint32_t offset) const;
+	unsigned int scanSet(const unsigned int from) const;
+	bool resize(const unsigned int c, const unsigned int size, const unsigned int limit);
+	bool push(const unsigned int base, unsigned int& top, const uint32_t start, const uint32_t end);
+	bool merge(const uint8_t op, Runs a, Runs b, const unsigned int base, unsigned int& top);
+	bool encode(const unsigned int c, const unsigned int base, const unsigned int top, const bool bitmap);
+	bool recode(const unsigned int c, const bool bitmap);
+	void apply(const unsigned int c, const uint8_t op, const uint8_t kind, const uint16_t* data, const unsigned int size);
+	void applyRange(const uint8_t op, const unsigned int from, const unsigned int to);
+	void empty(const unsigned int c);
+	static uint8_t best(const uint32_t bits, const unsigned int runs);
+	static unsigned int lowerBound(const uint16_t* data, const unsigned int size, const uint32_t offset);
+	static bool contains(const uint8_t kind, const uint16_t* data, const unsigned int size, const uint32_t offset);
+	static void fill(uint16_t* bitmap, uint32_t start, const uint32_t end, const bool value);
+};
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::Runs::next(uint32_t& start, uint32_t& end) {
+	if (_kind == ARRAY) {
+		if (_position >= _length) {
+			return false;
+		}
+		start = _data[_position++];
+		end = start + 1;
+		while (_position < _length && _data[_position] == end) {
+			_position++;
+			end++;
+		}
+		return true;
+	}
+	if (_kind == RUN) {
+		if (_position >= _length) {
+			return false;
+		}
+		start = _data[_position];
+		end = start + _data[_position + 1] + 1;
+		_position += 2;
+		return true;
+	}
+	// bitmap: _position is a bit offset, find the next set bit and then the next clear one
+	unsigned int w = _position / 16;
+	if (w >= _length) {
+		return false;
+	}
+	unsigned int bits = _data[w] & (0xFFFFU << (_position & 15));
+	while (!bits) {
+		if (++w >= _length) {
+			_position = _length * 16;
+			return false;
+		}
+		bits = _data[w];
+	}
+	start = w * 16 + __builtin_ctz(bits);
+	bits = ~_data[w] & (0xFFFFU << (start & 15)) & 0xFFFFU;
+	while (!bits) {
+		if (++w >= _length) {
+			end = _position = _length * 16;
+			return true;
+		}
+		bits = ~_data[w] & 0xFFFFU;
+	}
+	end = _position = w * 16 + __builtin_ctz(bits);
+	return true;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+CompressedBitSet<C, S, B, E>::CompressedBitSet() {
+	clear();
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+constexpr size_t CompressedBitSet<C, S, B, E>::footprint() {
+	return sizeof(CompressedBitSet);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline unsigned int CompressedBitSet<C, S, B, E>::size() const {
+	return C;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+unsigned int CompressedBitSet<C, S, B, E>::count() const {
+	unsigned int result = 0;
+	for (unsigned int c = 0; c < CHUNKS; c++) {
+		result += _count[c];
+	}
+	return result;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline unsigned int CompressedBitSet<C, S, B, E>::usedWords() const {
+	return _start[CHUNKS];
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline bool CompressedBitSet<C, S, B, E>::assertValidRange(const unsigned int i) const {
+	if (i < C) {
+		return true;
+	}
+	E(CollectionError::OutOfBound);
+	return false;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline bool CompressedBitSet<C, S, B, E>::assertValidRange(const unsigned int from, const unsigned int to) const {
+	if (from <= to && to <= C) {
+		return true;
+	}
+	E(CollectionError::OutOfBound);
+	return false;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline unsigned int CompressedBitSet<C, S, B, E>::length(const unsigned int c) const {
+	return _start[c + 1] - _start[c];
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline typename CompressedBitSet<C, S, B, E>::Runs CompressedBitSet<C, S, B, E>::runs(const unsigned int c) const {
+	return Runs(_kind[c], &_pool[_start[c]], length(c));
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+unsigned int CompressedBitSet<C, S, B, E>::lowerBound(const uint16_t* data, const unsigned int size, const uint32_t offset) {
+	unsigned int low = 0;
+	unsigned int high = size;
+	while (low < high) {
+		const unsigned int mid = (low + high) / 2;
+		if (data[mid] < offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::contains(const uint8_t kind, const uint16_t* data, const unsigned int size, const uint32_t offset) {
+	if (kind == BITMAP) {
+		return (data[offset / 16] >> (offset & 15)) & 1;
+	}
+	if (kind == ARRAY) {
+		const unsigned int i = lowerBound(data, size, offset);
+		return i < size && data[i] == offset;
+	}
+	unsigned int low = 0;
+	unsigned int high = size / 2;
+	while (low < high) {
+		const unsigned int mid = (low + high) / 2;
+		if (data[mid * 2] <= offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low > 0 && offset <= (uint32_t)data[low * 2 - 2] + data[low * 2 - 1];
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::fill(uint16_t* bitmap, uint32_t start, const uint32_t end, const bool value) {
+	while (start < end) {
+		const unsigned int shift = start & 15;
+		const unsigned int bits = end - start < 16 - shift ? end - start : 16 - shift;
+		const uint16_t mask = (uint16_t)((((uint32_t)1 << bits) - 1) << shift);
+		if (value) {
+			bitmap[start / 16] |= mask;
+		} else {
+			bitmap[start / 16] &= ~mask;
+		}
+		start += bits;
+	}
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+uint8_t CompressedBitSet<C, S, B, E>::best(const uint32_t bits, const unsigned int runs) {
+	const uint32_t array = bits <= BITMAP_WORDS ? bits : BITMAP_WORDS + 1;
+	if (runs * 2 < array && runs * 2 < BITMAP_WORDS) {
+		return RUN;
+	}
+	return array <= BITMAP_WORDS ? ARRAY : BITMAP;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline bool CompressedBitSet<C, S, B, E>::operator[](const unsigned int i) const {
+	if (assertValidRange(i)) {
+		const unsigned int c = i / B;
+		return contains(_kind[c], &_pool[_start[c]], length(c), i % B);
+	}
+	return false;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::resize(const unsigned int c, const unsigned int size, const unsigned int limit) {
+	const unsigned int used = _start[CHUNKS];
+	const int delta = (int)size - (int)length(c);
+	if (delta > 0 && used + delta > limit) {
+		return false;
+	}
+	memmove(&_pool[_start[c + 1] + delta], &_pool[_start[c + 1]], (used - _start[c + 1]) * sizeof(uint16_t));
+	for (unsigned int j = c + 1; j <= CHUNKS; j++) {
+		_start[j] += delta;
+	}
+	return true;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::empty(const unsigned int c) {
+	resize(c, 0, S);
+	_kind[c] = ARRAY;
+	_count[c] = 0;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::push(const unsigned int base, unsigned int& top, const uint32_t start, const uint32_t end) {
+	// runs are collected as (start, length - 1) pairs in the free part of the pool, coalescing touching ones
+	if (top > base) {
+		const uint32_t last = (uint32_t)_pool[top - 2] + _pool[top - 1] + 1;
+		if (start <= last) {
+			if (end > last) {
+				_pool[top - 1] = end - _pool[top - 2] - 1;
+			}
+			return true;
+		}
+	}
+	if (top + 2 > S) {
+		return false;
+	}
+	_pool[top++] = start;
+	_pool[top++] = end - start - 1;
+	return true;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::merge(const uint8_t op, Runs a, Runs b, const unsigned int base, unsigned int& top) {
+	uint32_t as, ae, bs, be;
+	bool ha = a.next(as, ae);
+	bool hb = b.next(bs, be);
+	if (op == OR) {
+		while (ha || hb) {
+			if (hb && (!ha || bs < as)) {
+				if (!push(base, top, bs, be)) {
+					return false;
+				}
+				hb = b.next(bs, be);
+			} else {
+				if (!push(base, top, as, ae)) {
+					return false;
+				}
+				ha = a.next(as, ae);
+			}
+		}
+	} else if (op == AND) {
+		while (ha && hb) {
+			const uint32_t start = as > bs ? as : bs;
+			const uint32_t end = ae < be ? ae : be;
+			if (start < end && !push(base, top, start, end)) {
+				return false;
+			}
+			if (ae < be) {
+				ha = a.next(as, ae);
+			} else {
+				hb = b.next(bs, be);
+			}
+		}
+	} else {
+		while (ha) {
+			if (hb && be <= as) {
+				hb = b.next(bs, be);
+			} else if (!hb || bs >= ae) {
+				if (!push(base, top, as, ae)) {
+					return false;
+				}
+				ha = a.next(as, ae);
+			} else {
+				if (bs > as && !push(base, top, as, bs)) {
+					return false;
+				}
+				if (be < ae) {
+					as = be;
+					hb = b.next(bs, be);
+				} else {
+					ha = a.next(as, ae);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::encode(const unsigned int c, const unsigned int base, const unsigned int top, const bool bitmap) {
+	uint32_t bits = 0;
+	for (unsigned int r = base; r < top; r += 2) {
+		bits += (uint32_t)_pool[r + 1] + 1;
+	}
+	const uint8_t kind = bitmap ? BITMAP : best(bits, (top - base) / 2);
+	const unsigned int size = kind == BITMAP ? BITMAP_WORDS : kind == RUN ? top - base : bits;
+	// move the runs out of the way to the end of the pool before the chunk is resized
+	const unsigned int runs = S - (top - base);
+	memmove(&_pool[runs], &_pool[base], (top - base) * sizeof(uint16_t));
+	if (!resize(c, size, runs)) {
+		return false;
+	}
+	uint16_t* data = &_pool[_start[c]];
+	if (kind == RUN) {
+		memcpy(data, &_pool[runs], (top - base) * sizeof(uint16_t));
+	} else if (kind == BITMAP) {
+		memset(data, 0, BITMAP_WORDS * sizeof(uint16_t));
+		for (unsigned int r = runs; r < S; r += 2) {
+			fill(data, _pool[r], (uint32_t)_pool[r] + _pool[r + 1] + 1, true);
+		}
+	} else {
+		for (unsigned int r = runs; r < S; r += 2) {
+			for (uint32_t i = _pool[r], end = i + _pool[r + 1] + 1; i < end; i++) {
+				*data++ = i;
+			}
+		}
+	}
+	_kind[c] = kind;
+	_count[c] = bits;
+	return true;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+bool CompressedBitSet<C, S, B, E>::recode(const unsigned int c, const bool bitmap) {
+	const unsigned int base = _start[CHUNKS];
+	unsigned int top = base;
+	Runs source = runs(c);
+	uint32_t start, end;
+	while (source.next(start, end)) {
+		if (!push(base, top, start, end)) {
+			return false;
+		}
+	}
+	return encode(c, base, top, bitmap);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::apply(const unsigned int c, const uint8_t op, const uint8_t kind, const uint16_t* data, const unsigned int size) {
+	if (_kind[c] == ARRAY && op != OR) {
+		// the result is a subset of the array, so it can be filtered in place
+		uint16_t* values = &_pool[_start[c]];
+		unsigned int kept = 0;
+		for (unsigned int i = 0; i < length(c); i++) {
+			if (contains(kind, data, size, values[i]) == (op == AND)) {
+				values[kept++] = values[i];
+			}
+		}
+		resize(c, kept, S);
+		_count[c] = kept;
+		return;
+	}
+	if (_kind[c] == BITMAP || kind == BITMAP) {
+		if (_kind[c] != BITMAP && !recode(c, true)) {
+			E(CollectionError::OutOfSpace);
+			return;
+		}
+		uint16_t* bitmap = &_pool[_start[c]];
+		if (kind == BITMAP) {
+			for (unsigned int w = 0; w < BITMAP_WORDS; w++) {
+				bitmap[w] = op == OR ? bitmap[w] | data[w] : op == AND ? bitmap[w] & data[w] : bitmap[w] & ~data[w];
+			}
+		} else {
+			Runs other(kind, data, size);
+			uint32_t start, end, last = 0;
+			while (other.next(start, end)) {
+				if (op == AND) {
+					fill(bitmap, last, start, false);
+					last = end;
+				} else {
+					fill(bitmap, start, end, op == OR);
+				}
+			}
+			if (op == AND) {
+				fill(bitmap, last, B, false);
+			}
+		}
+		uint32_t bits = 0;
+		for (unsigned int w = 0; w < BITMAP_WORDS; w++) {
+			bits += __builtin_popcount(bitmap[w]);
+		}
+		_count[c] = bits;
+		if (bits <= BITMAP_WORDS) {
+			// stays a valid bitmap if there is no room to convert it
+			recode(c, false);
+		}
+		return;
+	}
+	const unsigned int base = _start[CHUNKS];
+	unsigned int top = base;
+	if (!merge(op, runs(c), Runs(kind, data, size), base, top) || !encode(c, base, top, false)) {
+		E(CollectionError::OutOfSpace);
+	}
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::applyRange(const uint8_t op, const unsigned int from, const unsigned int to) {
+	if (!assertValidRange(from, to) || from == to) {
+		return;
+	}
+	for (unsigned int c = from / B; c < CHUNKS && c * B < to; c++) {
+		const uint32_t start = from > c * B ? from - c * B : 0;
+		const uint32_t end = to - c * B < B ? to - c * B : B;
+		const uint16_t run[2] = { (uint16_t)start, (uint16_t)(end - start - 1) };
+		apply(c, op, RUN, run, 2);
+	}
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::set(const unsigned int i) {
+	if (!assertValidRange(i)) {
+		return;
+	}
+	const unsigned int c = i / B;
+	const uint16_t offset = i % B;
+	if (_kind[c] == BITMAP) {
+		uint16_t& word = _pool[_start[c] + offset / 16];
+		if (!(word & (1U << (offset & 15)))) {
+			word |= 1U << (offset & 15);
+			_count[c]++;
+		}
+		return;
+	}
+	if (_kind[c] == ARRAY) {
+		const unsigned int size = length(c);
+		const unsigned int at = lowerBound(&_pool[_start[c]], size, offset);
+		if (at < size && _pool[_start[c] + at] == offset) {
+			return;
+		}
+		if (size < BITMAP_WORDS) {
+			if (!resize(c, size + 1, S)) {
+				E(CollectionError::OutOfSpace);
+				return;
+			}
+			uint16_t* values = &_pool[_start[c]];
+			memmove(&values[at + 1], &values[at], (size - at) * sizeof(uint16_t));
+			values[at] = offset;
+			_count[c]++;
+			return;
+		}
+	}
+	const uint16_t run[2] = { offset, 0 };
+	apply(c, OR, RUN, run, 2);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::unset(const unsigned int i) {
+	if (!assertValidRange(i)) {
+		return;
+	}
+	const unsigned int c = i / B;
+	const uint16_t offset = i % B;
+	if (_kind[c] == BITMAP) {
+		uint16_t& word = _pool[_start[c] + offset / 16];
+		if (word & (1U << (offset & 15))) {
+			word &= ~(1U << (offset & 15));
+			if (--_count[c] <= BITMAP_WORDS) {
+				recode(c, false);
+			}
+		}
+		return;
+	}
+	const uint16_t run[2] = { offset, 0 };
+	apply(c, AND_NOT, RUN, run, 2);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::clear() {
+	memset(&_start[0], 0, sizeof(_start));
+	memset(&_kind[0], ARRAY, sizeof(_kind));
+	memset(&_count[0], 0, sizeof(_count));
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline void CompressedBitSet<C, S, B, E>::setRange(const unsigned int from, const unsigned int to) {
+	applyRange(OR, from, to);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline void CompressedBitSet<C, S, B, E>::clearRange(const unsigned int from, const unsigned int to) {
+	applyRange(AND_NOT, from, to);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+uint32_t CompressedBitSet<C, S, B, E>::nextInChunk(const unsigned int c, const uint32_t offset) const {
+	const uint16_t* data = &_pool[_start[c]];
+	const unsigned int size = length(c);
+	if (_kind[c] == ARRAY) {
+		const unsigned int i = lowerBound(data, size, offset);
+		return i < size ? data[i] : B;
+	}
+	if (_kind[c] == RUN) {
+		for (unsigned int r = 0; r < size; r += 2) {
+			if (offset <= (uint32_t)data[r] + data[r + 1]) {
+				return offset > data[r] ? offset : data[r];
+			}
+		}
+		return B;
+	}
+	unsigned int w = offset / 16;
+	unsigned int bits = data[w] & (0xFFFFU << (offset & 15));
+	while (!bits) {
+		if (++w >= BITMAP_WORDS) {
+			return B;
+		}
+		bits = data[w];
+	}
+	return w * 16 + __builtin_ctz(bits);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+unsigned int CompressedBitSet<C, S, B, E>::scanSet(const unsigned int from) const {
+	uint32_t offset = from % B;
+	for (unsigned int c = from / B; c < CHUNKS; c++) {
+		if (_count[c] > 0) {
+			const uint32_t next = nextInChunk(c, offset);
+			if (next < B) {
+				return c * B + next;
+			}
+		}
+		offset = 0;
+	}
+	return C;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline unsigned int CompressedBitSet<C, S, B, E>::findFirstSet() const {
+	return scanSet(0);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline unsigned int CompressedBitSet<C, S, B, E>::findNextSet(const unsigned int i) const {
+	if (i + 1 >= C) {
+		return C;
+	}
+	return scanSet(i + 1);
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+CompressedBitSet<C, S, B, E>& CompressedBitSet<C, S, B, E>::operator|=(const CompressedBitSet& other) {
+	if (&other != this) {
+		for (unsigned int c = 0; c < CHUNKS; c++) {
+			if (other._count[c] > 0) {
+				apply(c, OR, other._kind[c], &other._pool[other._start[c]], other.length(c));
+			}
+		}
+	}
+	return *this;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+CompressedBitSet<C, S, B, E>& CompressedBitSet<C, S, B, E>::operator&=(const CompressedBitSet& other) {
+	if (&other != this) {
+		for (unsigned int c = 0; c < CHUNKS; c++) {
+			if (other._count[c] == 0) {
+				empty(c);
+			} else if (_count[c] > 0) {
+				apply(c, AND, other._kind[c], &other._pool[other._start[c]], other.length(c));
+			}
+		}
+	}
+	return *this;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+CompressedBitSet<C, S, B, E>& CompressedBitSet<C, S, B, E>::andNot(const CompressedBitSet& other) {
+	if (&other == this) {
+		clear();
+		return *this;
+	}
+	for (unsigned int c = 0; c < CHUNKS; c++) {
+		if (other._count[c] > 0 && _count[c] > 0) {
+			apply(c, AND_NOT, other._kind[c], &other._pool[other._start[c]], other.length(c));
+		}
+	}
+	return *this;
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+void CompressedBitSet<C, S, B, E>::optimize() {
+	for (unsigned int c = 0; c < CHUNKS; c++) {
+		unsigned int count = 0;
+		Runs source = runs(c);
+		uint32_t start, end;
+		while (source.next(start, end)) {
+			count++;
+		}
+		if (best(_count[c], count) != _kind[c]) {
+			recode(c, false);
+		}
+	}
+}
+
+template<unsigned int C, unsigned int S, unsigned int B, CollectionErrorHandler E>
+inline typename CompressedBitSet<C, S, B, E>::SetBits CompressedBitSet<C, S, B, E>::setBits() const {
+	return SetBits(this);
+}
+
+#endif
\ No newline at end of file
@@ -22,7 +22,10 @@
 #define _Deque_H
 
 #include <Arduino.h>
+#include <utility>
 #include "CollectionError.h"
+#include "IndexType.h"
+#include "RawArray.h"
 #include "iterator_tpl.h"
 
 template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
@@ -57,31 +60,100 @@ private:
 			return _index != s._index; 
 		}
 	private:
-		unsigned int _index;
+		IndexType<C> _index;
 	};
 public:
+	// A contiguous run of slots in the ring storage.
+	struct Segment {
+		T* data;
+		unsigned int size;
+	};
+	// The ring wraps around at most once, so any range of slots is covered by two segments.
+	struct Segments {
+		Segment first;
+		Segment second;
+	};
+	static constexpr size_t footprint();
+	static constexpr size_t overhead();
+	Deque();
+	Deque(const Deque& other);
+	~Deque();
+	Deque& operator=(const Deque& other);
 	unsigned int capacity() const;
 	unsigned int size() const;
 	bool isFull() const;
 	bool isEmpty() const;
-	bool push(T value);
+	T& operator[](const unsigned int index);
+	const T& operator[](const unsigned int index) const;
+	bool push(const T& value);
+	bool push(T&& value);
+	template<typename... Args>
+	bool emplaceFront(Args&&... args);
 	T pop();
 	bool tryPop(T& value);
-	bool unshift(T value);
+	bool unshift(const T& value);
+	bool unshift(T&& value);
+	template<typename... Args>
+	bool emplaceBack(Args&&... args);
 	T shift();
 	bool tryShift(T& value);
 	T peekFront() const;
 	T peekBack() const;
+	unsigned int pushBulk(const T* values, const unsigned int count);
+	unsigned int shiftBulk(T* values, const unsigned int count);
+	Segments readableSegments();
+	Segments writableSegments();
+	void commitWrite(const unsigned int count);
+	void consume(const unsigned int count);
+	void clear();
 	SETUP_ITERATORS(Deque, T&, IteratorState);
 	SETUP_REVERSE_ITERATORS(Deque, T&, IteratorState);
 private:
-	T _data[SLOTS];
-	unsigned int _head;
-	unsigned int _tail;
+	RawArray<T, SLOTS> _data;
+	IndexType<C> _head;
+	IndexType<C> _tail;
 	bool assertNotFull() const;
 	bool assertNotEmpty() const;
+	Segments segments(const unsigned int from, const unsigned int count);
 };
 
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t Deque<T, C, E>::footprint() {
+	return sizeof(Deque);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t Deque<T, C, E>::overhead() {
+	return sizeof(Deque) - sizeof(T) * C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+Deque<T, C, E>::Deque(): _head(0), _tail(0) {
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+Deque<T, C, E>::Deque(const Deque& other): _head(0), _tail(0) {
+	*this = other;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+Deque<T, C, E>::~Deque() {
+	clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+Deque<T, C, E>& Deque<T, C, E>::operator=(const Deque& other) {
+	if (this != &other) {
+		clear();
+		for (unsigned int i = other._tail; i != other._head; i = (i + 1) % SLOTS) {
+			_data.construct(i, other._data[i]);
+		}
+		_head = other._head;
+		_tail = other._tail;
+	}
+	return *this;
+}
+
 template<typename T, unsigned int C, CollectionErrorHandler E>
 inline unsigned int Deque<T, C, E>::capacity() const {
 	return C;
@@ -89,7 +161,7 @@ inline unsigned int Deque<T, C, E>::capacity() const {
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
 inline unsigned int Deque<T, C, E>::size() const {
-	return _head >= _tail ? _tail - _head : SLOTS - _tail + _head;
+	return _head >= _tail ? _head - _tail : SLOTS - _tail + _head;
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
@@ -102,10 +174,48 @@ inline bool Deque<T, C, E>::isEmpty() const {
 	return _tail == _head;
 }
 
+// Index 0 is the oldest element (the one shift would return), size() - 1 the newest.
 template<typename T, unsigned int C, CollectionErrorHandler E>
-bool Deque<T, C, E>::push(T value) {
+inline T& Deque<T, C, E>::operator[](const unsigned int index) {
+	if (index >= size()) {
+		E(CollectionError::OutOfBound);
+	}
+	return _data[(_tail + index) % SLOTS];
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline const T& Deque<T, C, E>::operator[](const unsigned int index) const {
+	if (index >= size()) {
+		E(CollectionError::OutOfBound);
+	}
+	return _data[(_tail + index) % SLOTS];
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool Deque<T, C, E>::push(const T& value) {
+	if (assertNotFull()) {
+		_data.construct(_head, value);
+		_head = (_head + 1) % SLOTS;
+		return true;
+	}
+	return false;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool Deque<T, C, E>::push(T&& value) {
+	if (assertNotFull()) {
+		_data.construct(_head, std::move(value));
+		_head = (_head + 1) % SLOTS;
+		return true;
+	}
+	return false;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+template<typename... Args>
+bool Deque<T, C, E>::emplaceFront(Args&&... args) {
 	if (assertNotFull()) {
-		_data[_head] = value;
+		_data.construct(_head, std::forward<Args>(args)...);
 		_head = (_head + 1) % SLOTS;
 		return true;
 	}
@@ -116,7 +226,9 @@ template<typename T, unsigned int C, CollectionErrorHandler E>
 T Deque<T, C, E>::pop() {
 	if (assertNotEmpty()) {
 		_head = _head == 0 ? SLOTS - 1 : _head - 1;
-		return _data[_head];
+		T value(std::move(_data[_head]));
+		_data.destroy(_head);
+		return value;
 	}
 	return T();
 }
@@ -127,15 +239,37 @@ bool Deque<T, C, E>::tryPop(T& value) {
 		return false;
 	}
 	_head = _head == 0 ? SLOTS - 1 : _head - 1;
-	value = _data[_head];
+	value = std::move(_data[_head]);
+	_data.destroy(_head);
 	return true;
 }
 
 template<typename T, unsigned int C, CollectionErrorHandler E>
-bool Deque<T, C, E>::unshift(T value) {
+bool Deque<T, C, E>::unshift(const T& value) {
+	if (assertNotFull()) {
+		_tail = _tail == 0 ? SLOTS - 1 : _tail - 1;
+		_data.construct(_tail, value);
+		return true;
+	}
+	return false;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool Deque<T, C, E>::unshift(T&& value) {
+	if (assertNotFull()) {
+		_tail = _tail == 0 ? SLOTS - 1 : _tail - 1;
+		_data.construct(_tail, std::move(value));
+		return true;
+	}
+	return false;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+template<typename... Args>
+bool Deque<T, C, E>::emplaceBack(Args&&... args) {
 	if (assertNotFull()) {
 		_tail = _tail == 0 ? SLOTS - 1 : _tail - 1;
-		_data[_tail] = value;
+		_data.construct(_tail, std::forward<Args>(args)...);
 		return true;
 	}
 	return false;
@@ -144,9 +278,10 @@ bool Deque<T, C, E>::unshift(T value) {
 template<typename T, unsigned int C, CollectionErrorHandler E>
 T Deque<T, C, E>::shift() {
 	if (assertNotEmpty()) {
-		const unsigned int tail = _tail;
+		T value(std::move(_data[_tail]));
+		_data.destroy(_tail);
 		_tail = (_tail + 1) % SLOTS;
-		return _data[tail];
+		return value;
 	}
 	return T();
 }
@@ -156,7 +291,8 @@ bool Deque<T, C, E>::tryShift(T& value) {
 	if (isEmpty()) {
 		return false;
 	}
-	value = _data[_tail];
+	value = std::move(_data[_tail]);
+	_data.destroy(_tail);
 	_tail = (_tail + 1) % SLOTS;
 	return true;
 }
@@ -177,6 +313,106 @@ T Deque<T, C, E>::peekBack() const {
 	return T();
 }
 
+template<typename T, unsigned int C, CollectionErrorHandler E>
+typename Deque<T, C, E>::Segments Deque<T, C, E>::segments(const unsigned int from, const unsigned int count) {
+	const unsigned int first = count < SLOTS - from ? count : SLOTS - from;
+	Segments result;
+	result.first.data = &_data[from];
+	result.first.size = first;
+	result.second.data = &_data[0];
+	result.second.size = count - first;
+	return result;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int Deque<T, C, E>::pushBulk(const T* values, const unsigned int count) {
+	const unsigned int room = C - size();
+	const unsigned int n = count < room ? count : room;
+	if (n < count) {
+		E(CollectionError::OutOfSpace);
+	}
+	const Segments target = segments(_head, n);
+	if (RawArray<T, SLOTS>::TRIVIAL_COPY) {
+		memcpy((void*)target.first.data, values, target.first.size * sizeof(T));
+		memcpy((void*)target.second.data, values + target.first.size, target.second.size * sizeof(T));
+	} else {
+		for (unsigned int i = 0; i < n; i++) {
+			_data.construct((_head + i) % SLOTS, values[i]);
+		}
+	}
+	_head = (_head + n) % SLOTS;
+	return n;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int Deque<T, C, E>::shiftBulk(T* values, const unsigned int count) {
+	const unsigned int available = size();
+	const unsigned int n = count < available ? count : available;
+	const Segments source = segments(_tail, n);
+	if (RawArray<T, SLOTS>::TRIVIAL_COPY) {
+		memcpy((void*)values, source.first.data, source.first.size * sizeof(T));
+		memcpy((void*)(values + source.first.size), source.second.data, source.second.size * sizeof(T));
+		_tail = (_tail + n) % SLOTS;
+	} else {
+		for (unsigned int i = 0; i < n; i++) {
+			values[i] = std::move(_data[_tail]);
+			_data.destroy(_tail);
+			_tail = (_tail + 1) % SLOTS;
+		}
+	}
+	return n;
+}
+
+// The live elements from the oldest to the newest, for reading them in place.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline typename Deque<T, C, E>::Segments Deque<T, C, E>::readableSegments() {
+	return segments(_tail, size());
+}
+
+// The free slots after the newest element. They can be filled directly and then added with commitWrite;
+// since the slots are uninitialized, this is only available for trivially copyable types.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline typename Deque<T, C, E>::Segments Deque<T, C, E>::writableSegments() {
+	static_assert(RawArray<T, SLOTS>::TRIVIAL_COPY, "writable segments require a trivially copyable type");
+	return segments(_head, C - size());
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void Deque<T, C, E>::commitWrite(const unsigned int count) {
+	static_assert(RawArray<T, SLOTS>::TRIVIAL_COPY, "writable segments require a trivially copyable type");
+	if (count > C - size()) {
+		E(CollectionError::OutOfBound);
+		return;
+	}
+	_head = (_head + count) % SLOTS;
+}
+
+// Removes the given number of oldest elements, typically after reading them through readableSegments.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void Deque<T, C, E>::consume(const unsigned int count) {
+	if (count > size()) {
+		E(CollectionError::OutOfBound);
+		return;
+	}
+	if (!RawArray<T, SLOTS>::TRIVIAL_DESTROY) {
+		for (unsigned int i = 0; i < count; i++) {
+			_data.destroy((_tail + i) % SLOTS);
+		}
+	}
+	_tail = (_tail + count) % SLOTS;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void Deque<T, C, E>::clear() {
+	if (!RawArray<T, SLOTS>::TRIVIAL_DESTROY) {
+		for (unsigned int i = _tail; i != _head; i = (i + 1) % SLOTS) {
+			_data.destroy(i);
+		}
+	}
+	_head = 0;
+	_tail = 0;
+}
+
 template<typename T, unsigned int C, CollectionErrorHandler E>
 inline bool Deque<T, C, E>::assertNotFull() const {
 	if (isFull()) {
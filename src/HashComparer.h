@@ -23,64 +23,336 @@
 
 #include <Arduino.h>
 
+// Borrowed pointer and length of a string which is not null-terminated; used
+// to look up String keys without constructing a String.
+class StringRef {
+public:
+	const char* data;
+	unsigned int length;
+	StringRef(const char* data, unsigned int length): data(data), length(length) {}
+};
+
 class StringHashComparer {
 public:
-	static unsigned int getHash(String value);
-	static bool equals(String x, String y);
+	static unsigned int getHash(const String& value);
+	static unsigned int getHash(const char* value);
+	static unsigned int getHash(const __FlashStringHelper* value);
+	static unsigned int getHash(const StringRef& value);
+	static bool equals(const String& x, const String& y);
+	static bool equals(const char* x, const String& y);
+	static bool equals(const __FlashStringHelper* x, const String& y);
+	static bool equals(const StringRef& x, const String& y);
 private:
 	StringHashComparer() {}
+	static unsigned int getHash(const char* value, unsigned int length);
 };
 
 class StringIgnoreCaseHashComparer {
 public:
-	static unsigned int getHash(String value);
-	 static bool equals(String x, String y);
+	static unsigned int getHash(const String& value);
+	static unsigned int getHash(const char* value);
+	static unsigned int getHash(const __FlashStringHelper* value);
+	static unsigned int getHash(const StringRef& value);
+	static bool equals(const String& x, const String& y);
+	static bool equals(const char* x, const String& y);
+	static bool equals(const __FlashStringHelper* x, const String& y);
+	static bool equals(const StringRef& x, const String& y);
 private:
 	StringIgnoreCaseHashComparer() {}
+	static unsigned int getHash(const char* value, unsigned int length);
+};
+
+// 32-bit MurmurHash3 over the full length of a string, read a word at a time.
+// With IGNORECASE, the ASCII letters of every word are folded to lower case
+// before mixing it in.
+template <bool IGNORECASE>
+class StringWordHash {
+public:
+	static uint32_t of(const char* value, unsigned int length, uint32_t seed);
+	static uint32_t of(const __FlashStringHelper* value, uint32_t seed);
+private:
+	StringWordHash() {}
+	static uint32_t fold(uint32_t word);
+	static uint32_t mix(uint32_t h, uint32_t word);
+	static uint32_t finish(uint32_t h, uint32_t tail, unsigned int length);
+};
+
+// Hash comparers using StringWordHash; unlike StringHashComparer and
+// StringIgnoreCaseHashComparer, keys with long common prefixes do not collide.
+template <uint32_t SEED = 0>
+class StringFullHashComparer: public StringHashComparer {
+public:
+	static unsigned int getHash(const String& value);
+	static unsigned int getHash(const char* value);
+	static unsigned int getHash(const __FlashStringHelper* value);
+	static unsigned int getHash(const StringRef& value);
+};
+
+template <uint32_t SEED = 0>
+class StringIgnoreCaseFullHashComparer: public StringIgnoreCaseHashComparer {
+public:
+	static unsigned int getHash(const String& value);
+	static unsigned int getHash(const char* value);
+	static unsigned int getHash(const __FlashStringHelper* value);
+	static unsigned int getHash(const StringRef& value);
 };
 
 template <typename K>
 class GenericHashComparer {
 public:
-	static unsigned int getHash(const K value);
-	static bool equals(const K x, const K y);
+	static unsigned int getHash(const K& value);
+	static bool equals(const K& x, const K& y);
 private:
 	GenericHashComparer() {}
 };
 
+// Wraps another hash comparer and runs its hashes through an avalanche
+// finalizer, so that similar keys (e.g. sequential integers) spread out.
+template <class H>
+class MixingHashComparer {
+public:
+	template <typename K>
+	static unsigned int getHash(const K& value);
+	template <typename Q, typename K>
+	static bool equals(const Q& x, const K& y);
+private:
+	MixingHashComparer() {}
+};
+
+inline unsigned int mixHash(const unsigned int hash) {
+	if (sizeof(unsigned int) < 4) {
+		uint16_t h = hash;
+		h ^= h >> 8;
+		h *= 0x88B5U;
+		h ^= h >> 7;
+		h *= 0xDB2DU;
+		h ^= h >> 9;
+		return h;
+	}
+	// MurmurHash3 fmix32
+	uint32_t h = hash;
+	h ^= h >> 16;
+	h *= 0x85EBCA6BUL;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35UL;
+	h ^= h >> 16;
+	return h;
+}
+
+template <class H>
+template <typename K>
+inline unsigned int MixingHashComparer<H>::getHash(const K& value) {
+	return mixHash(H::getHash(value));
+}
+
+template <class H>
+template <typename Q, typename K>
+inline bool MixingHashComparer<H>::equals(const Q& x, const K& y) {
+	return H::equals(x, y);
+}
+
 template <typename K>
-inline unsigned int GenericHashComparer<K>::getHash(const K value) {
+inline unsigned int GenericHashComparer<K>::getHash(const K& value) {
 	return (unsigned int)value;
 }
 
 template <typename K>
-inline bool GenericHashComparer<K>::equals(const K x, const K y) {
+inline bool GenericHashComparer<K>::equals(const K& x, const K& y) {
 	return x == y;
 }
 
-unsigned int StringHashComparer::getHash(const String value) {
+unsigned int StringHashComparer::getHash(const char* value, unsigned int length) {
 	unsigned int h = 37;
-	for (int i = std::min(31, (int)(value.length()-1)); i >= 0; i--) {
-		h = (h * 54059) ^ (value.charAt(i) * 76963);
+	for (int i = std::min(31, (int)length - 1); i >= 0; i--) {
+		h = (h * 54059) ^ (value[i] * 76963);
 	}
 	return h; // or return h % C;
 }
 
-bool StringHashComparer::equals(const String x, const String y) {
+unsigned int StringHashComparer::getHash(const String& value) {
+	return getHash(value.c_str(), value.length());
+}
+
+unsigned int StringHashComparer::getHash(const char* value) {
+	return getHash(value, strlen(value));
+}
+
+unsigned int StringHashComparer::getHash(const __FlashStringHelper* value) {
+	// only the first 32 characters are hashed, so they are all we need in RAM
+	char buffer[32];
+	const unsigned int length = strlen_P((PGM_P)value);
+	memcpy_P(buffer, (PGM_P)value, std::min(32U, length));
+	return getHash(buffer, length);
+}
+
+unsigned int StringHashComparer::getHash(const StringRef& value) {
+	return getHash(value.data, value.length);
+}
+
+bool StringHashComparer::equals(const String& x, const String& y) {
 	return x.equals(y);
 }
 
-unsigned int StringIgnoreCaseHashComparer::getHash(const String value) {
+bool StringHashComparer::equals(const char* x, const String& y) {
+	return strcmp(x, y.c_str()) == 0;
+}
+
+bool StringHashComparer::equals(const __FlashStringHelper* x, const String& y) {
+	return strcmp_P(y.c_str(), (PGM_P)x) == 0;
+}
+
+bool StringHashComparer::equals(const StringRef& x, const String& y) {
+	return x.length == y.length() && memcmp(x.data, y.c_str(), x.length) == 0;
+}
+
+unsigned int StringIgnoreCaseHashComparer::getHash(const char* value, unsigned int length) {
 	unsigned int h = 37;
-	for (int i = std::min(31, (int)(value.length()-1)); i >= 0; i--) {
+	for (int i = std::min(31, (int)length - 1); i >= 0; i--) {
 		// rough uppercase computation is good enough for hashing
-		h = (h * 54059) ^ ((value.charAt(i) & 0xDF) * 76963); 
+		h = (h * 54059) ^ ((value[i] & 0xDF) * 76963); 
 	}
 	return h; // or return h % C;
 }
 
-bool StringIgnoreCaseHashComparer::equals(const String x, const String y) {
+unsigned int StringIgnoreCaseHashComparer::getHash(const String& value) {
+	return getHash(value.c_str(), value.length());
+}
+
+unsigned int StringIgnoreCaseHashComparer::getHash(const char* value) {
+	return getHash(value, strlen(value));
+}
+
+unsigned int StringIgnoreCaseHashComparer::getHash(const __FlashStringHelper* value) {
+	char buffer[32];
+	const unsigned int length = strlen_P((PGM_P)value);
+	memcpy_P(buffer, (PGM_P)value, std::min(32U, length));
+	return getHash(buffer, length);
+}
+
+unsigned int StringIgnoreCaseHashComparer::getHash(const StringRef& value) {
+	return getHash(value.data, value.length);
+}
+
+bool StringIgnoreCaseHashComparer::equals(const String& x, const String& y) {
 	return x.equalsIgnoreCase(y);
 }
 
-#endif
\ No newline at end of file
+bool StringIgnoreCaseHashComparer::equals(const char* x, const String& y) {
+	return strcasecmp(x, y.c_str()) == 0;
+}
+
+bool StringIgnoreCaseHashComparer::equals(const __FlashStringHelper* x, const String& y) {
+	return strcasecmp_P(y.c_str(), (PGM_P)x) == 0;
+}
+
+bool StringIgnoreCaseHashComparer::equals(const StringRef& x, const String& y) {
+	return x.length == y.length() && strncasecmp(x.data, y.c_str(), x.length) == 0;
+}
+
+template <bool IGNORECASE>
+inline uint32_t StringWordHash<IGNORECASE>::fold(uint32_t word) {
+	if (IGNORECASE) {
+		// set the high bit of every byte in 'A'..'Z', then move it onto the 0x20 case bit
+		const uint32_t heptets = word & 0x7F7F7F7FUL;
+		const uint32_t aboveA = heptets + 0x3F3F3F3FUL; // 0x80 - 'A'
+		const uint32_t aboveZ = heptets + 0x25252525UL; // 0x80 - 'Z' - 1
+		word |= (aboveA & ~aboveZ & ~word & 0x80808080UL) >> 2;
+	}
+	return word;
+}
+
+template <bool IGNORECASE>
+inline uint32_t StringWordHash<IGNORECASE>::mix(uint32_t h, uint32_t word) {
+	word *= 0xCC9E2D51UL;
+	word = (word << 15) | (word >> 17);
+	word *= 0x1B873593UL;
+	h ^= word;
+	h = (h << 13) | (h >> 19);
+	return h * 5 + 0xE6546B64UL;
+}
+
+template <bool IGNORECASE>
+uint32_t StringWordHash<IGNORECASE>::finish(uint32_t h, uint32_t tail, unsigned int length) {
+	if (length & 3) {
+		tail *= 0xCC9E2D51UL;
+		tail = (tail << 15) | (tail >> 17);
+		tail *= 0x1B873593UL;
+		h ^= tail;
+	}
+	h ^= length;
+	h ^= h >> 16;
+	h *= 0x85EBCA6BUL;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35UL;
+	h ^= h >> 16;
+	return h;
+}
+
+template <bool IGNORECASE>
+uint32_t StringWordHash<IGNORECASE>::of(const char* value, unsigned int length, uint32_t seed) {
+	uint32_t word;
+	unsigned int i = 0;
+	for (; i + 4 <= length; i += 4) {
+		memcpy(&word, value + i, 4);
+		seed = mix(seed, fold(word));
+	}
+	word = 0;
+	memcpy(&word, value + i, length - i);
+	return finish(seed, fold(word), length);
+}
+
+template <bool IGNORECASE>
+uint32_t StringWordHash<IGNORECASE>::of(const __FlashStringHelper* value, uint32_t seed) {
+	const unsigned int length = strlen_P((PGM_P)value);
+	uint32_t word;
+	unsigned int i = 0;
+	for (; i + 4 <= length; i += 4) {
+		memcpy_P(&word, (PGM_P)value + i, 4);
+		seed = mix(seed, fold(word));
+	}
+	word = 0;
+	memcpy_P(&word, (PGM_P)value + i, length - i);
+	return finish(seed, fold(word), length);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringFullHashComparer<SEED>::getHash(const String& value) {
+	return StringWordHash<false>::of(value.c_str(), value.length(), SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringFullHashComparer<SEED>::getHash(const char* value) {
+	return StringWordHash<false>::of(value, strlen(value), SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringFullHashComparer<SEED>::getHash(const __FlashStringHelper* value) {
+	return StringWordHash<false>::of(value, SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringFullHashComparer<SEED>::getHash(const StringRef& value) {
+	return StringWordHash<false>::of(value.data, value.length, SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringIgnoreCaseFullHashComparer<SEED>::getHash(const String& value) {
+	return StringWordHash<true>::of(value.c_str(), value.length(), SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringIgnoreCaseFullHashComparer<SEED>::getHash(const char* value) {
+	return StringWordHash<true>::of(value, strlen(value), SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringIgnoreCaseFullHashComparer<SEED>::getHash(const __FlashStringHelper* value) {
+	return StringWordHash<true>::of(value, SEED);
+}
+
+template <uint32_t SEED>
+inline unsigned int StringIgnoreCaseFullHashComparer<SEED>::getHash(const StringRef& value) {
+	return StringWordHash<true>::of(value.data, value.length, SEED);
+}
+
+#endif
@@ -22,12 +22,14 @@
 #define _HashMap_H
 
 #include <Arduino.h>
+#include <utility>
 #include "CollectionError.h"
 #include "HashComparer.h"
-#include "BitSet.h"
+#include "HashProbing.h"
+#include "IndexType.h"
 #include "iterator_tpl.h"
 
-template<typename K, typename V, unsigned int C, class H = GenericHashComparer<K>, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+template<typename K, typename V, unsigned int C, class H = GenericHashComparer<K>, CollectionErrorHandler E = IgnoreCollectionErrorHandler, template<typename, typename, unsigned int, class> class P = LinearProbing>
 class HashMap {
 public:
 	class Pair {
@@ -37,62 +39,75 @@ public:
 		Pair(const K& key, const V& value): key(key), value(value) {}
 	};
 private:
+	struct Entry {
+		K key;
+		V value;
+		template<typename Q, typename... Args>
+		Entry(Q&& key, Args&&... args): key(std::forward<Q>(key)), value(std::forward<Args>(args)...) {}
+	};
 	class IteratorState {
 	public:
 		inline void next(const HashMap* map) { 
 			if (_bucket < C) { 
-				while (++_bucket < C) { 
-					if (map->_used[_bucket]) {
-						return;
-					}; 
-				}
+				_bucket = map->_table.next(_bucket);
 			}
 		}
 		inline void begin(const HashMap* map) {
-			_bucket = 0; 
+			_bucket = map->_table.first(); 
 		}
 		inline void end(const HashMap* map) { 
 			_bucket = C; 
 		}
 		inline Pair get(HashMap* map) {
-			if (assertValidBucket(_bucket)) {
-				return Pair(map->_keys[_bucket], map->_values[_bucket]);
-			}
+			assertValidBucket(_bucket);
+			return Pair(map->_table[_bucket].key, map->_table[_bucket].value);
 		}
 		inline const Pair get(const HashMap* map) { 
-			if (assertValidBucket(_bucket)) {
-				return Pair(map->_keys[_bucket], map->_values[_bucket]);
-			}
+			assertValidBucket(_bucket);
+			return Pair(map->_table[_bucket].key, map->_table[_bucket].value);
 		}
 		inline bool cmp(const IteratorState& s) const { 
 			return _bucket != s._bucket; 
 		}
 	private:
-		unsigned int _bucket;
+		IndexType<C> _bucket;
 	};
 public:
+	static constexpr size_t footprint();
+	static constexpr size_t overhead();
 	unsigned int capacity() const;
 	unsigned int size() const;
 	bool isFull() const;
-	bool containsKey(K key) const;
-	bool tryGet(K key, V& value) const;
-	V operator[](K key) const;
-	void add(K key, V value);
-	void set(K key, V value);
-	bool remove(K key);
+	template<typename Q>
+	bool containsKey(const Q& key) const;
+	template<typename Q>
+	bool tryGet(const Q& key, V& value) const;
+	template<typename Q>
+	V operator[](const Q& key) const;
+	template<typename Q>
+	V* find(const Q& key);
+	template<typename Q>
+	const V* find(const Q& key) const;
+	template<typename Q, typename W>
+	V* getOrInsert(Q&& key, W&& value);
+	template<typename Q, typename... Args>
+	V* tryEmplace(Q&& key, Args&&... args);
+	template<typename Q, typename W>
+	void add(Q&& key, W&& value);
+	template<typename Q, typename W>
+	void set(Q&& key, W&& value);
+	template<typename Q>
+	bool remove(const Q& key);
 	void clear();
 	SETUP_ITERATORS(HashMap, Pair, IteratorState);
 private:
-	BitSet<C> _used;
-	K _keys[C];
-	V _values[C];
-	unsigned int _size;
+	P<K, Entry, C, H> _table;
 
 	static bool assertValidBucket(const unsigned int bucket);
 };
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-bool HashMap<K, V, C, H, E>::assertValidBucket(const unsigned int bucket) {
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+bool HashMap<K, V, C, H, E, P>::assertValidBucket(const unsigned int bucket) {
 	if (bucket < C) {
 		return true;
 	}
@@ -100,128 +115,148 @@ bool HashMap<K, V, C, H, E>::assertValidBucket(const unsigned int bucket) {
 	return false;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-inline unsigned int HashMap<K, V, C, H, E>::capacity() const {
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+constexpr size_t HashMap<K, V, C, H, E, P>::footprint() {
+	return sizeof(HashMap);
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+constexpr size_t HashMap<K, V, C, H, E, P>::overhead() {
+	return sizeof(HashMap) - (sizeof(K) + sizeof(V)) * C;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+inline unsigned int HashMap<K, V, C, H, E, P>::capacity() const {
 	return C;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-inline unsigned int HashMap<K, V, C, H, E>::size() const {
-	return _size;
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+inline unsigned int HashMap<K, V, C, H, E, P>::size() const {
+	return _table.size();
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-inline bool HashMap<K, V, C, H, E>::isFull() const  {
-	return _size >= C;
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+inline bool HashMap<K, V, C, H, E, P>::isFull() const  {
+	return _table.size() >= C;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-bool HashMap<K, V, C, H, E>::containsKey(K key) const  {
-	if (_size > 0) {
-		unsigned int bucket = H::getHash(key) % C;
-		while (_used[bucket]) {
-			if (H::equals(key, _keys[bucket])) {
-				return true;
-			}
-			bucket++;
-		}
-	}
-	return false;
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashMap<K, V, C, H, E, P>::containsKey(const Q& key) const  {
+	return _table.find(key) < C;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-bool HashMap<K, V, C, H, E>::tryGet(K key, V& value) const  {
-	if (_size > 0) {
-		unsigned int bucket = H::getHash(key) % C;
-		while (_used[bucket]) {
-			if (H::equals(key, _keys[bucket])) {
-				value = _values[bucket];
-				return true;
-			}
-			bucket++;
-		}
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashMap<K, V, C, H, E, P>::tryGet(const Q& key, V& value) const  {
+	const V* found = find(key);
+	if (found) {
+		value = *found;
+		return true;
 	}
 	return false;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-V HashMap<K, V, C, H, E>::operator[](K key) const {
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+V HashMap<K, V, C, H, E, P>::operator[](const Q& key) const {
 	V value;
-	if (!tryGet(key, &value)) {
+	if (!tryGet(key, value)) {
 		E(CollectionError::KeyNotFound);
 	}
 	return value;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-void HashMap<K, V, C, H, E>::add(K key, V value) {
-	if (isFull()) {
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+V* HashMap<K, V, C, H, E, P>::find(const Q& key) {
+	const unsigned int bucket = _table.find(key);
+	return bucket < C ? &_table[bucket].value : nullptr;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+const V* HashMap<K, V, C, H, E, P>::find(const Q& key) const {
+	const unsigned int bucket = _table.find(key);
+	return bucket < C ? &_table[bucket].value : nullptr;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q, typename W>
+V* HashMap<K, V, C, H, E, P>::getOrInsert(Q&& key, W&& value) {
+	bool inserted;
+	const unsigned int bucket = _table.insert(key, inserted);
+	if (bucket >= C) {
+		E(CollectionError::OutOfSpace);
+		return nullptr;
+	}
+	if (inserted) {
+		_table.construct(bucket, std::forward<Q>(key), std::forward<W>(value));
+	}
+	return &_table[bucket].value;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q, typename... Args>
+V* HashMap<K, V, C, H, E, P>::tryEmplace(Q&& key, Args&&... args) {
+	bool inserted;
+	const unsigned int bucket = _table.insert(key, inserted);
+	if (bucket >= C) {
+		E(CollectionError::OutOfSpace);
+		return nullptr;
+	}
+	if (inserted) {
+		_table.construct(bucket, std::forward<Q>(key), std::forward<Args>(args)...);
+	}
+	return &_table[bucket].value;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q, typename W>
+void HashMap<K, V, C, H, E, P>::add(Q&& key, W&& value) {
+	bool inserted;
+	const unsigned int bucket = _table.insert(key, inserted);
+	if (bucket >= C) {
 		E(CollectionError::OutOfSpace);
 		return;
 	}
-	unsigned int bucket = H::getHash(key) % C;
-	while (_used[bucket]) {
-		if (H::equals(key, _keys[bucket])) {
-			E(CollectionError::DuplicateKey);
-			return;
-		}
-		bucket = (bucket + 1) % C;
+	if (!inserted) {
+		E(CollectionError::DuplicateKey);
+		return;
 	}
-	_used.set(bucket);
-	_keys[bucket] = key;
-	_size++;
-	_values[bucket] = value;
-}
-
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-void HashMap<K, V, C, H, E>::set(K key, V value) {
-	const unsigned int startBucket = H::getHash(key) % C;
-	unsigned int bucket = startBucket;
-	while (_used[bucket]) {
-		if (H::equals(key, _keys[bucket])) {
-			_values[bucket] = value;
-			return;
-		}
-		bucket = (bucket + 1) % C;
-		if (bucket == startBucket) {
-			E(CollectionError::OutOfSpace);
-			return;
-		}
+	_table.construct(bucket, std::forward<Q>(key), std::forward<W>(value));
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q, typename W>
+void HashMap<K, V, C, H, E, P>::set(Q&& key, W&& value) {
+	bool inserted;
+	const unsigned int bucket = _table.insert(key, inserted);
+	if (bucket >= C) {
+		E(CollectionError::OutOfSpace);
+		return;
 	}
-	_used.set(bucket);
-	_keys[bucket] = key;
-	_size++;
-	_values[bucket] = value;
-}
-
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-bool HashMap<K, V, C, H, E>::remove(K key) {
-	if (_size > 0) {
-		unsigned int bucket = H::getHash(key) % C;
-		while (_used[bucket]) {
-			if (H::equals(key, _keys[bucket])) {
-				_keys[bucket] = K();
-				_values[bucket] = V();
-				_used.unset(bucket);
-				_size--;
-				return true;
-			}
-			bucket++;
-		}
+	if (inserted) {
+		_table.construct(bucket, std::forward<Q>(key), std::forward<W>(value));
+	} else {
+		_table[bucket].value = std::forward<W>(value);
 	}
-	return false;
 }
 
-template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E>
-void HashMap<K, V, C, H, E>::clear() {
-	for (unsigned int bucket = 0; bucket < C; bucket++) {
-		if (_used[bucket]) {
-			_keys[bucket] = K();
-			_values[bucket] = V();
-		}
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashMap<K, V, C, H, E, P>::remove(const Q& key) {
+	const unsigned int bucket = _table.find(key);
+	if (bucket < C) {
+		_table.remove(bucket);
+		return true;
 	}
-	_used.clear();
-	_size = 0;
+	return false;
+}
+
+template<typename K, typename V, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+void HashMap<K, V, C, H, E, P>::clear() {
+	_table.clear();
 }
 
-#endif
\ No newline at end of file
+#endif
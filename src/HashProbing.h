@@ -0,0 +1,825 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _HashProbing_H
+#define _HashProbing_H
+
+#include <Arduino.h>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "BitSet.h"
+#include "IndexType.h"
+#include "RawArray.h"
+
+// Probing strategies used as storage by HashMap and HashSet. Each one owns the
+// entries of type T and locates them by the key K, hashed with H. A bucket
+// returned by insert() for a new key is uninitialized and must be filled with
+// construct() before the table is used again.
+
+// Maps hashes onto C buckets; a power of two C is detected at compile time
+// so that masking and shifting replace the division.
+template<unsigned int C>
+class HashBucket {
+public:
+	static constexpr bool POWER_OF_TWO = (C & (C - 1)) == 0;
+	static inline unsigned int of(const unsigned int hash) {
+		return POWER_OF_TWO ? hash & (C - 1) : hash % C;
+	}
+	static inline unsigned int rest(const unsigned int hash) {
+		return POWER_OF_TWO ? hash >> shift(C) : hash / C;
+	}
+	static inline unsigned int next(const unsigned int bucket) {
+		return POWER_OF_TWO ? (bucket + 1) & (C - 1) : (bucket + 1 < C ? bucket + 1 : 0);
+	}
+private:
+	static constexpr unsigned int shift(const unsigned int c) {
+		return c > 1 ? 1 + shift(c >> 1) : 0;
+	}
+};
+
+template<typename K, typename T>
+class HashEntry {
+public:
+	static inline const K& keyOf(const T& entry) {
+		return entry.key;
+	}
+};
+
+template<typename K>
+class HashEntry<K, K> {
+public:
+	static inline const K& keyOf(const K& entry) {
+		return entry;
+	}
+};
+
+// Keeps the hash of every bucket when CACHED, so that keys are only compared
+// when their hashes match and entries can be relocated without rehashing.
+template<typename K, unsigned int C, class H, bool CACHED>
+class HashCache {
+public:
+	inline bool matches(const unsigned int bucket, const unsigned int hash) const {
+		return _hashes[bucket] == hash;
+	}
+	inline unsigned int get(const unsigned int bucket, const K& key) const {
+		return _hashes[bucket];
+	}
+	inline void set(const unsigned int bucket, const unsigned int hash) {
+		_hashes[bucket] = hash;
+	}
+	inline void move(const unsigned int to, const unsigned int from) {
+		_hashes[to] = _hashes[from];
+	}
+private:
+	unsigned int _hashes[C];
+};
+
+template<typename K, unsigned int C, class H>
+class HashCache<K, C, H, false> {
+public:
+	inline bool matches(const unsigned int bucket, const unsigned int hash) const {
+		return true;
+	}
+	inline unsigned int get(const unsigned int bucket, const K& key) const {
+		return H::getHash(key);
+	}
+	inline void set(const unsigned int bucket, const unsigned int hash) {}
+	inline void move(const unsigned int to, const unsigned int from) {}
+};
+
+// Plain linear probing; occupancy is tracked in a BitSet and removal shifts
+// the following entries back so that no tombstones are needed.
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+class LinearProbingTable {
+public:
+	LinearProbingTable();
+	LinearProbingTable(const LinearProbingTable& other);
+	~LinearProbingTable();
+	LinearProbingTable& operator=(const LinearProbingTable& other);
+	unsigned int size() const;
+	bool isUsed(const unsigned int bucket) const;
+	T& operator[](const unsigned int bucket);
+	const T& operator[](const unsigned int bucket) const;
+	template<typename Q>
+	unsigned int find(const Q& key) const;
+	template<typename Q>
+	unsigned int insert(const Q& key, bool& inserted);
+	template<typename... Args>
+	void construct(const unsigned int bucket, Args&&... args);
+	void remove(unsigned int bucket);
+	unsigned int first() const;
+	unsigned int next(unsigned int bucket) const;
+	void clear();
+private:
+	BitSet<C> _used;
+	HashCache<K, C, H, CACHED> _hashes;
+	RawArray<T, C> _entries;
+	IndexType<C> _size;
+};
+
+template<typename K, typename T, unsigned int C, class H>
+using LinearProbing = LinearProbingTable<K, T, C, H, false>;
+
+template<typename K, typename T, unsigned int C, class H>
+using CachedLinearProbing = LinearProbingTable<K, T, C, H, true>;
+
+// Robin Hood probing; every slot stores its distance from the home bucket
+// (0 meaning empty), which keeps the clusters sorted by home bucket. Lookups
+// stop as soon as they reach an entry which is closer to its home than the
+// probe is, and removal shifts the cluster back.
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+class RobinHoodProbingTable {
+public:
+	RobinHoodProbingTable();
+	RobinHoodProbingTable(const RobinHoodProbingTable& other);
+	~RobinHoodProbingTable();
+	RobinHoodProbingTable& operator=(const RobinHoodProbingTable& other);
+	unsigned int size() const;
+	bool isUsed(const unsigned int bucket) const;
+	T& operator[](const unsigned int bucket);
+	const T& operator[](const unsigned int bucket) const;
+	template<typename Q>
+	unsigned int find(const Q& key) const;
+	template<typename Q>
+	unsigned int insert(const Q& key, bool& inserted);
+	template<typename... Args>
+	void construct(const unsigned int bucket, Args&&... args);
+	void remove(unsigned int bucket);
+	unsigned int first() const;
+	unsigned int next(unsigned int bucket) const;
+	void clear();
+private:
+	// number of distances tested at once when skipping empty runs
+	static constexpr unsigned int SPAN = sizeof(unsigned int) / sizeof(IndexType<C>);
+	IndexType<C> _distance[C];
+	HashCache<K, C, H, CACHED> _hashes;
+	RawArray<T, C> _entries;
+	IndexType<C> _size;
+};
+
+template<typename K, typename T, unsigned int C, class H>
+using RobinHoodProbing = RobinHoodProbingTable<K, T, C, H, false>;
+
+template<typename K, typename T, unsigned int C, class H>
+using CachedRobinHoodProbing = RobinHoodProbingTable<K, T, C, H, true>;
+
+// Swiss table style probing; every slot has a control byte which is either
+// empty, deleted or holds a 7 bit fingerprint of the hash. The control bytes
+// are matched a whole group at a time, and keys are only compared on a
+// fingerprint match. Removed slots become tombstones unless their group still
+// has an empty slot, since probes never continue past such a group.
+template<typename K, typename T, unsigned int C, class H>
+class SwissProbing {
+public:
+	SwissProbing();
+	SwissProbing(const SwissProbing& other);
+	~SwissProbing();
+	SwissProbing& operator=(const SwissProbing& other);
+	unsigned int size() const;
+	bool isUsed(const unsigned int bucket) const;
+	T& operator[](const unsigned int bucket);
+	const T& operator[](const unsigned int bucket) const;
+	template<typename Q>
+	unsigned int find(const Q& key) const;
+	template<typename Q>
+	unsigned int insert(const Q& key, bool& inserted);
+	template<typename... Args>
+	void construct(const unsigned int bucket, Args&&... args);
+	void remove(unsigned int bucket);
+	unsigned int first() const;
+	unsigned int next(unsigned int bucket) const;
+	void clear();
+private:
+	static constexpr uint8_t EMPTY = 0x80;
+	static constexpr uint8_t DELETED = 0xFE;
+	static constexpr uint8_t SENTINEL = 0xFF;
+#if defined(__SSE2__)
+	static constexpr unsigned int WIDTH = 16;
+	typedef unsigned int Mask;
+#else
+	static constexpr unsigned int WIDTH = 8;
+	typedef uint64_t Mask;
+	static constexpr uint64_t LSBS = 0x0101010101010101ULL;
+	static constexpr uint64_t MSBS = 0x8080808080808080ULL;
+#endif
+	static constexpr unsigned int GROUPS = (C + WIDTH - 1) / WIDTH;
+	uint8_t _ctrl[GROUPS * WIDTH];
+	RawArray<T, C> _entries;
+	IndexType<C> _size;
+	IndexType<C> _deleted;
+	void rehash();
+	static Mask match(const uint8_t* group, const uint8_t fingerprint);
+	static Mask matchEmpty(const uint8_t* group);
+	static Mask matchEmptyOrDeleted(const uint8_t* group);
+	static Mask matchFull(const uint8_t* group);
+	static Mask dropBelow(const Mask mask, const unsigned int slot);
+	static unsigned int lowest(const Mask mask);
+};
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+LinearProbingTable<K, T, C, H, CACHED>::LinearProbingTable(): _size(0) {
+	_used.clear();
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+LinearProbingTable<K, T, C, H, CACHED>::LinearProbingTable(const LinearProbingTable& other): _size(0) {
+	_used.clear();
+	*this = other;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+LinearProbingTable<K, T, C, H, CACHED>::~LinearProbingTable() {
+	clear();
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+LinearProbingTable<K, T, C, H, CACHED>& LinearProbingTable<K, T, C, H, CACHED>::operator=(const LinearProbingTable& other) {
+	if (this != &other) {
+		clear();
+		for (unsigned int bucket = other.first(); bucket < C; bucket = other.next(bucket)) {
+			_entries.construct(bucket, other._entries[bucket]);
+		}
+		_used = other._used;
+		_hashes = other._hashes;
+		_size = other._size;
+	}
+	return *this;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline unsigned int LinearProbingTable<K, T, C, H, CACHED>::size() const {
+	return _size;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline bool LinearProbingTable<K, T, C, H, CACHED>::isUsed(const unsigned int bucket) const {
+	return _used[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline T& LinearProbingTable<K, T, C, H, CACHED>::operator[](const unsigned int bucket) {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline const T& LinearProbingTable<K, T, C, H, CACHED>::operator[](const unsigned int bucket) const {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename Q>
+unsigned int LinearProbingTable<K, T, C, H, CACHED>::find(const Q& key) const {
+	if (_size > 0) {
+		const unsigned int hash = H::getHash(key);
+		unsigned int bucket = HashBucket<C>::of(hash);
+		for (unsigned int probe = 0; probe < C && _used[bucket]; probe++) {
+			if (_hashes.matches(bucket, hash) && H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+				return bucket;
+			}
+			bucket = HashBucket<C>::next(bucket);
+		}
+	}
+	return C;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename Q>
+unsigned int LinearProbingTable<K, T, C, H, CACHED>::insert(const Q& key, bool& inserted) {
+	inserted = false;
+	const unsigned int hash = H::getHash(key);
+	unsigned int bucket = HashBucket<C>::of(hash);
+	for (unsigned int probe = 0; probe < C; probe++) {
+		if (!_used[bucket]) {
+			_used.set(bucket);
+			_hashes.set(bucket, hash);
+			_size++;
+			inserted = true;
+			return bucket;
+		}
+		if (_hashes.matches(bucket, hash) && H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+			return bucket;
+		}
+		bucket = HashBucket<C>::next(bucket);
+	}
+	return C;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename... Args>
+inline void LinearProbingTable<K, T, C, H, CACHED>::construct(const unsigned int bucket, Args&&... args) {
+	_entries.construct(bucket, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+void LinearProbingTable<K, T, C, H, CACHED>::remove(unsigned int bucket) {
+	unsigned int next = HashBucket<C>::next(bucket);
+	while (next != bucket && _used[next]) {
+		// move the entry into the hole unless its home lies cyclically in (bucket, next]
+		const unsigned int home = HashBucket<C>::of(_hashes.get(next, HashEntry<K, T>::keyOf(_entries[next])));
+		if (bucket <= next ? (home <= bucket || home > next) : (home <= bucket && home > next)) {
+			_entries[bucket] = std::move(_entries[next]);
+			_hashes.move(bucket, next);
+			bucket = next;
+		}
+		next = HashBucket<C>::next(next);
+	}
+	_entries.destroy(bucket);
+	_used.unset(bucket);
+	_size--;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline unsigned int LinearProbingTable<K, T, C, H, CACHED>::first() const {
+	return _used.findFirstSet();
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline unsigned int LinearProbingTable<K, T, C, H, CACHED>::next(unsigned int bucket) const {
+	return _used.findNextSet(bucket);
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+void LinearProbingTable<K, T, C, H, CACHED>::clear() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int bucket = first(); bucket < C; bucket = next(bucket)) {
+			_entries.destroy(bucket);
+		}
+	}
+	_used.clear();
+	_size = 0;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+RobinHoodProbingTable<K, T, C, H, CACHED>::RobinHoodProbingTable(): _size(0) {
+	memset(&_distance[0], 0, sizeof(_distance));
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+RobinHoodProbingTable<K, T, C, H, CACHED>::RobinHoodProbingTable(const RobinHoodProbingTable& other): _size(0) {
+	memset(&_distance[0], 0, sizeof(_distance));
+	*this = other;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+RobinHoodProbingTable<K, T, C, H, CACHED>::~RobinHoodProbingTable() {
+	clear();
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+RobinHoodProbingTable<K, T, C, H, CACHED>& RobinHoodProbingTable<K, T, C, H, CACHED>::operator=(const RobinHoodProbingTable& other) {
+	if (this != &other) {
+		clear();
+		for (unsigned int bucket = other.first(); bucket < C; bucket = other.next(bucket)) {
+			_entries.construct(bucket, other._entries[bucket]);
+		}
+		memcpy(&_distance[0], &other._distance[0], sizeof(_distance));
+		_hashes = other._hashes;
+		_size = other._size;
+	}
+	return *this;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline unsigned int RobinHoodProbingTable<K, T, C, H, CACHED>::size() const {
+	return _size;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline bool RobinHoodProbingTable<K, T, C, H, CACHED>::isUsed(const unsigned int bucket) const {
+	return _distance[bucket] != 0;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline T& RobinHoodProbingTable<K, T, C, H, CACHED>::operator[](const unsigned int bucket) {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+inline const T& RobinHoodProbingTable<K, T, C, H, CACHED>::operator[](const unsigned int bucket) const {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename Q>
+unsigned int RobinHoodProbingTable<K, T, C, H, CACHED>::find(const Q& key) const {
+	if (_size > 0) {
+		const unsigned int hash = H::getHash(key);
+		unsigned int bucket = HashBucket<C>::of(hash);
+		for (unsigned int distance = 1; distance <= C; distance++) {
+			if (_distance[bucket] < distance) {
+				break;
+			}
+			if (_distance[bucket] == distance && _hashes.matches(bucket, hash) && H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+				return bucket;
+			}
+			bucket = HashBucket<C>::next(bucket);
+		}
+	}
+	return C;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename Q>
+unsigned int RobinHoodProbingTable<K, T, C, H, CACHED>::insert(const Q& key, bool& inserted) {
+	inserted = false;
+	const unsigned int hash = H::getHash(key);
+	unsigned int bucket = HashBucket<C>::of(hash);
+	for (unsigned int distance = 1; distance <= C; distance++) {
+		if (_distance[bucket] < distance) {
+			if (_size >= C) {
+				return C;
+			}
+			if (_distance[bucket] != 0) {
+				// take the place of the richer entry by shifting the rest of the cluster forward
+				unsigned int hole = bucket;
+				while (_distance[hole] != 0) {
+					hole = HashBucket<C>::next(hole);
+				}
+				unsigned int prev = hole == 0 ? C - 1 : hole - 1;
+				_entries.construct(hole, std::move(_entries[prev]));
+				while (true) {
+					_hashes.move(hole, prev);
+					_distance[hole] = _distance[prev] + 1;
+					hole = prev;
+					if (hole == bucket) {
+						break;
+					}
+					prev = hole == 0 ? C - 1 : hole - 1;
+					_entries[hole] = std::move(_entries[prev]);
+				}
+				_entries.destroy(bucket);
+			}
+			_distance[bucket] = distance;
+			_hashes.set(bucket, hash);
+			_size++;
+			inserted = true;
+			return bucket;
+		}
+		if (_distance[bucket] == distance && _hashes.matches(bucket, hash) && H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+			return bucket;
+		}
+		bucket = HashBucket<C>::next(bucket);
+	}
+	return C;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+template<typename... Args>
+inline void RobinHoodProbingTable<K, T, C, H, CACHED>::construct(const unsigned int bucket, Args&&... args) {
+	_entries.construct(bucket, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+void RobinHoodProbingTable<K, T, C, H, CACHED>::remove(unsigned int bucket) {
+	unsigned int next = HashBucket<C>::next(bucket);
+	while (next != bucket && _distance[next] > 1) {
+		_entries[bucket] = std::move(_entries[next]);
+		_hashes.move(bucket, next);
+		_distance[bucket] = _distance[next] - 1;
+		bucket = next;
+		next = HashBucket<C>::next(next);
+	}
+	_entries.destroy(bucket);
+	_distance[bucket] = 0;
+	_size--;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+unsigned int RobinHoodProbingTable<K, T, C, H, CACHED>::first() const {
+	return _distance[0] != 0 ? 0 : next(0);
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+unsigned int RobinHoodProbingTable<K, T, C, H, CACHED>::next(unsigned int bucket) const {
+	while (++bucket < C) {
+		if (SPAN > 1 && bucket % SPAN == 0 && bucket + SPAN <= C) {
+			unsigned int word;
+			memcpy(&word, &_distance[bucket], sizeof(word));
+			if (word == 0) {
+				bucket += SPAN - 1;
+				continue;
+			}
+		}
+		if (_distance[bucket] != 0) {
+			break;
+		}
+	}
+	return bucket;
+}
+
+template<typename K, typename T, unsigned int C, class H, bool CACHED>
+void RobinHoodProbingTable<K, T, C, H, CACHED>::clear() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int bucket = first(); bucket < C; bucket = next(bucket)) {
+			_entries.destroy(bucket);
+		}
+	}
+	memset(&_distance[0], 0, sizeof(_distance));
+	_size = 0;
+}
+
+
+template<typename K, typename T, unsigned int C, class H>
+SwissProbing<K, T, C, H>::SwissProbing(): _size(0), _deleted(0) {
+	memset(&_ctrl[0], EMPTY, C);
+	memset(&_ctrl[C], SENTINEL, sizeof(_ctrl) - C);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+SwissProbing<K, T, C, H>::SwissProbing(const SwissProbing& other): SwissProbing() {
+	*this = other;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+SwissProbing<K, T, C, H>::~SwissProbing() {
+	clear();
+}
+
+template<typename K, typename T, unsigned int C, class H>
+SwissProbing<K, T, C, H>& SwissProbing<K, T, C, H>::operator=(const SwissProbing& other) {
+	if (this != &other) {
+		clear();
+		for (unsigned int bucket = other.first(); bucket < C; bucket = other.next(bucket)) {
+			_entries.construct(bucket, other._entries[bucket]);
+		}
+		memcpy(&_ctrl[0], &other._ctrl[0], sizeof(_ctrl));
+		_size = other._size;
+		_deleted = other._deleted;
+	}
+	return *this;
+}
+
+#if defined(__SSE2__)
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::match(const uint8_t* group, const uint8_t fingerprint) {
+	const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fingerprint), ctrl));
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchEmpty(const uint8_t* group) {
+	return match(group, EMPTY);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchEmptyOrDeleted(const uint8_t* group) {
+	// signed compare: EMPTY and DELETED are the only control bytes below SENTINEL
+	const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+	return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8((char)SENTINEL), ctrl));
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchFull(const uint8_t* group) {
+	const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+	return ~_mm_movemask_epi8(ctrl) & 0xFFFF;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::dropBelow(const Mask mask, const unsigned int slot) {
+	return mask & (~0U << slot);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline unsigned int SwissProbing<K, T, C, H>::lowest(const Mask mask) {
+	return __builtin_ctz(mask);
+}
+#else
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::match(const uint8_t* group, const uint8_t fingerprint) {
+	// may report false positives next to a real match, but only on used slots
+	uint64_t ctrl;
+	memcpy(&ctrl, group, sizeof(ctrl));
+	const uint64_t x = ctrl ^ (LSBS * fingerprint);
+	return (x - LSBS) & ~x & MSBS;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchEmpty(const uint8_t* group) {
+	uint64_t ctrl;
+	memcpy(&ctrl, group, sizeof(ctrl));
+	return ctrl & ~(ctrl << 6) & MSBS;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchEmptyOrDeleted(const uint8_t* group) {
+	uint64_t ctrl;
+	memcpy(&ctrl, group, sizeof(ctrl));
+	return ctrl & ~(ctrl << 7) & MSBS;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::matchFull(const uint8_t* group) {
+	uint64_t ctrl;
+	memcpy(&ctrl, group, sizeof(ctrl));
+	return ~ctrl & MSBS;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline typename SwissProbing<K, T, C, H>::Mask SwissProbing<K, T, C, H>::dropBelow(const Mask mask, const unsigned int slot) {
+	return mask & (~0ULL << (slot * 8));
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline unsigned int SwissProbing<K, T, C, H>::lowest(const Mask mask) {
+	return __builtin_ctzll(mask) >> 3;
+}
+#endif
+
+template<typename K, typename T, unsigned int C, class H>
+inline unsigned int SwissProbing<K, T, C, H>::size() const {
+	return _size;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline bool SwissProbing<K, T, C, H>::isUsed(const unsigned int bucket) const {
+	return (_ctrl[bucket] & 0x80) == 0;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline T& SwissProbing<K, T, C, H>::operator[](const unsigned int bucket) {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H>
+inline const T& SwissProbing<K, T, C, H>::operator[](const unsigned int bucket) const {
+	return _entries[bucket];
+}
+
+template<typename K, typename T, unsigned int C, class H>
+template<typename Q>
+unsigned int SwissProbing<K, T, C, H>::find(const Q& key) const {
+	if (_size > 0) {
+		const unsigned int hash = H::getHash(key);
+		const uint8_t fingerprint = HashBucket<GROUPS>::rest(hash) & 0x7F;
+		unsigned int group = HashBucket<GROUPS>::of(hash);
+		for (unsigned int probe = 0; probe < GROUPS; probe++) {
+			const uint8_t* ctrl = &_ctrl[group * WIDTH];
+			for (Mask mask = match(ctrl, fingerprint); mask != 0; mask &= mask - 1) {
+				const unsigned int bucket = group * WIDTH + lowest(mask);
+				if (H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+					return bucket;
+				}
+			}
+			if (matchEmpty(ctrl) != 0) {
+				break;
+			}
+			group = HashBucket<GROUPS>::next(group);
+		}
+	}
+	return C;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+template<typename Q>
+unsigned int SwissProbing<K, T, C, H>::insert(const Q& key, bool& inserted) {
+	inserted = false;
+	const unsigned int hash = H::getHash(key);
+	const uint8_t fingerprint = HashBucket<GROUPS>::rest(hash) & 0x7F;
+	unsigned int group = HashBucket<GROUPS>::of(hash);
+	unsigned int slot = C;
+	for (unsigned int probe = 0; probe < GROUPS; probe++) {
+		const uint8_t* ctrl = &_ctrl[group * WIDTH];
+		for (Mask mask = match(ctrl, fingerprint); mask != 0; mask &= mask - 1) {
+			const unsigned int bucket = group * WIDTH + lowest(mask);
+			if (H::equals(key, HashEntry<K, T>::keyOf(_entries[bucket]))) {
+				return bucket;
+			}
+		}
+		if (slot >= C) {
+			const Mask mask = matchEmptyOrDeleted(ctrl);
+			if (mask != 0) {
+				slot = group * WIDTH + lowest(mask);
+			}
+		}
+		if (matchEmpty(ctrl) != 0) {
+			break;
+		}
+		group = HashBucket<GROUPS>::next(group);
+	}
+	if (slot < C) {
+		if (_ctrl[slot] == DELETED) {
+			_deleted--;
+		}
+		_ctrl[slot] = fingerprint;
+		_size++;
+		inserted = true;
+	}
+	return slot;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+template<typename... Args>
+inline void SwissProbing<K, T, C, H>::construct(const unsigned int bucket, Args&&... args) {
+	_entries.construct(bucket, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+void SwissProbing<K, T, C, H>::remove(unsigned int bucket) {
+	_entries.destroy(bucket);
+	_size--;
+	if (matchEmpty(&_ctrl[bucket - bucket % WIDTH]) != 0) {
+		_ctrl[bucket] = EMPTY;
+	} else {
+		// a full group never gets an empty slot back by itself, so once the tombstones
+		// fill up the table every miss would have to scan all groups
+		_ctrl[bucket] = DELETED;
+		if (++_deleted > C / 16 && _size + _deleted > C - C / 8) {
+			rehash();
+		}
+	}
+}
+
+// Drops all tombstones in place: every entry is moved to the first free slot of its
+// probe sequence, which is never past the group it is in, or swapped with the entry
+// there if that one has not been moved yet.
+template<typename K, typename T, unsigned int C, class H>
+void SwissProbing<K, T, C, H>::rehash() {
+	for (unsigned int bucket = 0; bucket < C; bucket++) {
+		_ctrl[bucket] = isUsed(bucket) ? DELETED : EMPTY;
+	}
+	unsigned int bucket = 0;
+	while (bucket < C) {
+		if (_ctrl[bucket] != DELETED) {
+			bucket++;
+			continue;
+		}
+		const unsigned int hash = H::getHash(HashEntry<K, T>::keyOf(_entries[bucket]));
+		const uint8_t fingerprint = HashBucket<GROUPS>::rest(hash) & 0x7F;
+		unsigned int group = HashBucket<GROUPS>::of(hash);
+		Mask mask;
+		while ((mask = matchEmptyOrDeleted(&_ctrl[group * WIDTH])) == 0) {
+			group = HashBucket<GROUPS>::next(group);
+		}
+		const unsigned int target = group * WIDTH + lowest(mask);
+		if (group == bucket / WIDTH) {
+			_ctrl[bucket] = fingerprint;
+			bucket++;
+		} else if (_ctrl[target] == EMPTY) {
+			_entries.construct(target, std::move(_entries[bucket]));
+			_entries.destroy(bucket);
+			_ctrl[target] = fingerprint;
+			_ctrl[bucket] = EMPTY;
+			bucket++;
+		} else {
+			// the entry swapped in is processed next
+			std::swap(_entries[bucket], _entries[target]);
+			_ctrl[target] = fingerprint;
+		}
+	}
+	_deleted = 0;
+}
+
+template<typename K, typename T, unsigned int C, class H>
+unsigned int SwissProbing<K, T, C, H>::first() const {
+	return isUsed(0) ? 0 : next(0);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+unsigned int SwissProbing<K, T, C, H>::next(unsigned int bucket) const {
+	if (++bucket >= C) {
+		return C;
+	}
+	// padding slots past C hold SENTINEL and never match
+	unsigned int group = bucket / WIDTH;
+	Mask mask = dropBelow(matchFull(&_ctrl[group * WIDTH]), bucket % WIDTH);
+	while (mask == 0) {
+		if (++group >= GROUPS) {
+			return C;
+		}
+		mask = matchFull(&_ctrl[group * WIDTH]);
+	}
+	return group * WIDTH + lowest(mask);
+}
+
+template<typename K, typename T, unsigned int C, class H>
+void SwissProbing<K, T, C, H>::clear() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int bucket = first(); bucket < C; bucket = next(bucket)) {
+			_entries.destroy(bucket);
+		}
+	}
+	memset(&_ctrl[0], EMPTY, C);
+	_size = 0;
+	_deleted = 0;
+}
+
+#endif
@@ -22,127 +22,113 @@
 #define _HashSet_H
 
 #include <Arduino.h>
+#include <utility>
 #include "CollectionError.h"
 #include "HashComparer.h"
-#include "BitSet.h"
+#include "HashProbing.h"
+#include "IndexType.h"
 #include "iterator_tpl.h"
 
-template<typename K, unsigned int C, class H = GenericHashComparer<K>, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+template<typename K, unsigned int C, class H = GenericHashComparer<K>, CollectionErrorHandler E = IgnoreCollectionErrorHandler, template<typename, typename, unsigned int, class> class P = LinearProbing>
 class HashSet {
 private:
 	class IteratorState {
 	public:
 		inline void next(const HashSet* set) { 
 			if (_bucket < C) { 
-				while (++_bucket < C) { 
-					if (set->_used[_bucket]) {
-						return;
-					}; 
-				}
+				_bucket = set->_table.next(_bucket);
 			}
 		}
 		inline void begin(const HashSet* set) {
-			_bucket = 0; 
+			_bucket = set->_table.first(); 
 		}
 		inline void end(const HashSet* set) { 
 			_bucket = C; 
 		}
 		inline K get(HashSet* set) { 
-			return set->_keys[_bucket];
+			return set->_table[_bucket];
 		}
 		inline const K get(const HashSet* set) { 
-			return set->_keys[_bucket];
+			return set->_table[_bucket];
 		}
 		inline bool cmp(const IteratorState& s) const { 
 			return _bucket != s._bucket; 
 		}
 	private:
-		unsigned int _bucket;
+		IndexType<C> _bucket;
 	};
 public:
+	static constexpr size_t footprint();
+	static constexpr size_t overhead();
 	unsigned int size() const;
 	bool isFull() const;
-	bool operator[](K key) const;
-	bool add(K key);
-	bool remove(K key);
+	template<typename Q>
+	bool operator[](const Q& key) const;
+	template<typename Q>
+	bool add(Q&& key);
+	template<typename Q>
+	bool remove(const Q& key);
 	void clear();
 	SETUP_ITERATORS(HashSet, K, IteratorState);
 private:
-	BitSet<C> _used;
-	K _keys[C];
-	unsigned int _size;
+	P<K, K, C, H> _table;
 };
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-inline unsigned int HashSet<K, C, H, E>::size() const {
-	return _size;
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+constexpr size_t HashSet<K, C, H, E, P>::footprint() {
+	return sizeof(HashSet);
 }
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-inline bool HashSet<K, C, H, E>::isFull() const {
-	return _size >= C;
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+constexpr size_t HashSet<K, C, H, E, P>::overhead() {
+	return sizeof(HashSet) - sizeof(K) * C;
 }
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-bool HashSet<K, C, H, E>::operator[](K key) const {
-	if (_size > 0) {
-		unsigned int bucket = H::getHash(key) % C;
-		while (_used[bucket]) {
-			if (H::equals(key, _keys[bucket])) {
-				return true;
-			}
-			bucket++;
-		}
-	}
-	return false;
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+inline unsigned int HashSet<K, C, H, E, P>::size() const {
+	return _table.size();
 }
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-bool HashSet<K, C, H, E>::add(K key) {
-	const unsigned int startBucket = H::getHash(key) % C;
-	unsigned int bucket = startBucket;
-	while (_used[bucket]) {
-		if (H::equals(key, _keys[bucket])) {
-			return false;
-		}
-		bucket = (bucket + 1) % C;
-		if (bucket == startBucket) {
-			E(CollectionError::OutOfSpace);
-			return false;
-		}
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+inline bool HashSet<K, C, H, E, P>::isFull() const {
+	return _table.size() >= C;
+}
+
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashSet<K, C, H, E, P>::operator[](const Q& key) const {
+	return _table.find(key) < C;
+}
+
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashSet<K, C, H, E, P>::add(Q&& key) {
+	bool inserted;
+	const unsigned int bucket = _table.insert(key, inserted);
+	if (bucket >= C) {
+		E(CollectionError::OutOfSpace);
+		return false;
 	}
-	_used.set(bucket);
-	_keys[bucket] = key;
-	_size++;
-	return true;
+	if (inserted) {
+		_table.construct(bucket, std::forward<Q>(key));
+	}
+	return inserted;
 }
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-bool HashSet<K, C, H, E>::remove(K key) {
-	if (_size > 0) {
-		unsigned int bucket = H::getHash(key) % C;
-		while (_used[bucket]) {
-			if (H::equals(key, _keys[bucket])) {
-				_used.unset(bucket);
-				_keys[bucket] = K();
-				_size--;
-				return true;
-			}
-			bucket++;
-		}
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+template<typename Q>
+bool HashSet<K, C, H, E, P>::remove(const Q& key) {
+	const unsigned int bucket = _table.find(key);
+	if (bucket < C) {
+		_table.remove(bucket);
+		return true;
 	}
 	return false;
 }
 
-template<typename K, unsigned int C, class H, CollectionErrorHandler E>
-void HashSet<K, C, H, E>::clear() {
-	for (unsigned int bucket = 0; bucket < C; bucket++) {
-		if (_used[bucket]) {
-			_keys[bucket] = K();
-		}
-	}
-	_used.clear();
-	_size = 0;
+template<typename K, unsigned int C, class H, CollectionErrorHandler E, template<typename, typename, unsigned int, class> class P>
+void HashSet<K, C, H, E, P>::clear() {
+	_table.clear();
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _IndexType_H
+#define _IndexType_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// Smallest unsigned integer type which can hold all values up to N; used for
+// the sizes and positions of the collections so that small ones stay small.
+template<unsigned long N>
+using IndexType = typename std::conditional<(N <= 0xFFUL), uint8_t, typename std::conditional<(N <= 0xFFFFUL), uint16_t, uint32_t>::type>::type;
+
+#endif
@@ -22,14 +22,96 @@
 #define _MessageLoop_H
 
 #include <Arduino.h>
+#if defined(ESP8266)
 #include <user_interface.h>
-#include "Deque.h"
+#endif
 #include "CollectionError.h"
+#include "PriorityQueue.h"
+#if !defined(ARDUINO)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Lets processOrSleep() block until a message is posted. On Arduino the loop and everything posting to it
+// share one thread (posts from SDK callbacks happen while delay() yields), so locking is a no-op. On ESP8266
+// the sleep suspends the loop with esp_delay() for the whole time and a post resumes it right away. Other
+// boards cannot cut a delay() short, so they sleep in chunks of SLEEP_CHUNK_MS and notice a post (from an
+// interrupt) up to that late. Host builds may post from other threads and use a mutex and a condition
+// variable instead. A sleep of FOREVER only ends with a post.
+#if defined(ARDUINO)
+class MessageLoopWakeup {
+public:
+	static constexpr unsigned long FOREVER = ~0UL;
+	static constexpr unsigned long SLEEP_CHUNK_MS = 10;
+	MessageLoopWakeup(): _posted(false) {}
+	inline void lock() {}
+	inline void unlock() {}
+	inline void clear() { _posted = false; }
+#if defined(ESP8266)
+	inline void signal() { _posted = true; esp_schedule(); }
+	void sleep(const unsigned long ms) {
+		do {
+			esp_delay(ms, [this] { return !_posted; });
+		} while (ms == FOREVER && !_posted);
+	}
+#else
+	inline void signal() { _posted = true; }
+	void sleep(const unsigned long ms) {
+		const unsigned long start = millis();
+		while (!_posted) {
+			const unsigned long elapsed = millis() - start;
+			if (ms != FOREVER && elapsed >= ms) {
+				break;
+			}
+			const unsigned long left = ms - elapsed;
+			delay(ms == FOREVER || left > SLEEP_CHUNK_MS ? SLEEP_CHUNK_MS : left);
+		}
+	}
+#endif
+private:
+	volatile bool _posted;
+};
+#else
+class MessageLoopWakeup {
+public:
+	static constexpr unsigned long FOREVER = ~0UL;
+	MessageLoopWakeup(): _posted(false) {}
+	inline void lock() { _mutex.lock(); }
+	inline void unlock() { _mutex.unlock(); }
+	inline void clear() { _posted = false; }
+	inline void signal() { _posted = true; _condition.notify_all(); }
+	// Must be called with the lock held, which is released while waiting.
+	void sleep(const unsigned long ms) {
+		std::unique_lock<std::mutex> lock(_mutex, std::adopt_lock);
+		if (ms == FOREVER) {
+			_condition.wait(lock, [this] { return _posted; });
+		} else {
+			// clamped to the signed millis() range, as longer durations overflow in the clock's units
+			const unsigned long limited = ms < 0x7FFFFFFFUL ? ms : 0x7FFFFFFFUL;
+			_condition.wait_for(lock, std::chrono::milliseconds(limited), [this] { return _posted; });
+		}
+		lock.release();
+	}
+private:
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _posted;
+};
+#endif
 
 template <unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
 class MessageLoop {
 public:
+	// The outcome of a batch: how many messages ran, and how many milliseconds past its due time the first
+	// (and thus most overdue) of them was started.
+	struct ProcessResult {
+		unsigned int count;
+		unsigned long lateMs;
+	};
 	static constexpr unsigned int CSIZE = 4;
+	static constexpr unsigned long NO_DEADLINE = MessageLoopWakeup::FOREVER;
+	MessageLoop();
 	void post(int (*callbackFcn)(), int delayMs = 0);
 	template <typename T>
 	void post(int (*callbackFcn)(T*&), T* pData, int delayMs = 0);
@@ -37,7 +119,19 @@ public:
 	void post(int (*callbackFcn)(int&), int iData, int delayMs = 0);
 	void post(int (*callbackFcn)(unsigned int&), unsigned int iData, int delayMs = 0);
 	void process();
+	ProcessResult process(unsigned long budgetUs);
+	ProcessResult processAll();
+	ProcessResult processOrSleep(unsigned long maxSleepMs = NO_DEADLINE);
+	bool nextDeadline(unsigned long& tick) const;
+	unsigned long timeUntilNext() const;
 private:
+	class Lock {
+	public:
+		Lock(MessageLoopWakeup& wakeup): _wakeup(wakeup) { _wakeup.lock(); }
+		~Lock() { _wakeup.unlock(); }
+	private:
+		MessageLoopWakeup& _wakeup;
+	};
 	union MessageData {
 		void* pData;
 		int iData;
@@ -46,24 +140,58 @@ private:
 	struct Message {
 		int (*callbackFcn)(MessageData&);
 		unsigned long tick;
+		uint32_t sequence;
 		MessageData data;
 	};
 	static int invokeVoidFunction(MessageData& data);
-	Deque<Message, C, E> _messages;
+	static int compareMessages(const Message& x, const Message& y);
+	typedef PriorityQueue<Message, C, compareMessages, 2, E> Queue;
+	Queue _messages;
+	uint32_t _sequence;
+	mutable MessageLoopWakeup _wakeup;
+	void schedule(Message& msg, int delayMs);
+	bool runNext(const unsigned long now);
+	unsigned long waitTime() const;
 };
 
+template <unsigned int C, CollectionErrorHandler E>
+constexpr unsigned long MessageLoop<C, E>::NO_DEADLINE;
+
+template <unsigned int C, CollectionErrorHandler E>
+MessageLoop<C, E>::MessageLoop(): _sequence(0) {
+}
+
 template <unsigned int C, CollectionErrorHandler E>
 int MessageLoop<C, E>::invokeVoidFunction(MessageData& data) {
 	return data.fData();
 }
 
+// Orders by due time (wraparound safe as long as all delays are shorter than half the millis() range),
+// and messages due at the same time in the order they were scheduled.
+template <unsigned int C, CollectionErrorHandler E>
+int MessageLoop<C, E>::compareMessages(const Message& x, const Message& y) {
+	const long delta = (long)(x.tick - y.tick);
+	if (delta != 0) {
+		return delta < 0 ? -1 : 1;
+	}
+	return (int32_t)(x.sequence - y.sequence) < 0 ? -1 : 1;
+}
+
+template <unsigned int C, CollectionErrorHandler E>
+void MessageLoop<C, E>::schedule(Message& msg, int delayMs) {
+	Lock lock(_wakeup);
+	msg.tick = millis() + delayMs;
+	msg.sequence = _sequence++;
+	_messages.push(msg);
+	_wakeup.signal();
+}
+
 template <unsigned int C, CollectionErrorHandler E>
 void MessageLoop<C, E>::post(int(*callbackFcn)(), int delayMs) {
 	Message msg;
 	msg.callbackFcn = MessageLoop<C, E>::invokeVoidFunction;
 	msg.data.fData = callbackFcn;
-	msg.tick = millis() + delayMs;
-	_messages.push(msg);
+	schedule(msg, delayMs);
 }
 
 template <unsigned int C, CollectionErrorHandler E>
@@ -72,8 +200,7 @@ void MessageLoop<C, E>::post(int (*callbackFcn)(T*&), T* pData, int delayMs) {
 	Message msg;
 	msg.callbackFcn = (int (*)(MessageData&))callbackFcn;
 	msg.data.pData = pData;
-	msg.tick = millis() + delayMs;
-	_messages.push(msg);
+	schedule(msg, delayMs);
 }
 
 template <unsigned int C, CollectionErrorHandler E>
@@ -81,8 +208,7 @@ void MessageLoop<C, E>::post(int (*callbackFcn)(int&), int iData, int delayMs) {
 	Message msg;
 	msg.callbackFcn = (int (*)(MessageData&))callbackFcn;
 	msg.data.iData = iData;
-	msg.tick = millis() + delayMs;
-	_messages.push(msg);
+	schedule(msg, delayMs);
 }
 	
 template <unsigned int C, CollectionErrorHandler E>
@@ -90,8 +216,7 @@ void MessageLoop<C, E>::post(int (*callbackFcn)(bool&), bool bData, int delayMs)
 	Message msg;
 	msg.callbackFcn = (int (*)(MessageData&))callbackFcn;
 	msg.data.iData = bData;
-	msg.tick = millis() + delayMs;
-	_messages.push(msg);
+	schedule(msg, delayMs);
 }
 	
 template <unsigned int C, CollectionErrorHandler E>
@@ -99,24 +224,113 @@ void MessageLoop<C, E>::post(int (*callbackFcn)(unsigned int&), unsigned int iDa
 	Message msg;
 	msg.callbackFcn = (int (*)(MessageData&))callbackFcn;
 	msg.data.iData = (int)iData;
-	msg.tick = millis() + delayMs;
-	_messages.push(msg);
+	schedule(msg, delayMs);
 }
 	
+// Runs the earliest message if it is due.
 template <unsigned int C, CollectionErrorHandler E>
 void MessageLoop<C, E>::process() {
+	runNext(millis());
+}
+
+// Runs due messages in order until none is left or the budget is spent. The budget is checked before each
+// message, so a long callback can overrun it. Only messages due by the time the batch started are run,
+// so rescheduled messages wait for the next call.
+template <unsigned int C, CollectionErrorHandler E>
+typename MessageLoop<C, E>::ProcessResult MessageLoop<C, E>::process(unsigned long budgetUs) {
+	const unsigned long start = micros();
+	const unsigned long now = millis();
+	ProcessResult result = { 0, 0 };
+	{
+		Lock lock(_wakeup);
+		const typename Queue::Handle first = _messages.peekHandle();
+		if (first != Queue::NO_HANDLE && (long)(now - _messages[first].tick) > 0) {
+			result.lateMs = now - _messages[first].tick;
+		}
+	}
+	while (micros() - start < budgetUs && runNext(now)) {
+		result.count++;
+	}
+	return result;
+}
+
+// Runs all messages which are due, without a time budget.
+template <unsigned int C, CollectionErrorHandler E>
+inline typename MessageLoop<C, E>::ProcessResult MessageLoop<C, E>::processAll() {
+	return process(~0UL);
+}
+
+// Runs all due messages; if none is due, first sleeps until the earliest deadline (but at most maxSleepMs)
+// or until a message is posted, whichever comes first.
+template <unsigned int C, CollectionErrorHandler E>
+typename MessageLoop<C, E>::ProcessResult MessageLoop<C, E>::processOrSleep(unsigned long maxSleepMs) {
+	ProcessResult result = processAll();
+	if (result.count > 0) {
+		return result;
+	}
+	_wakeup.lock();
+	_wakeup.clear();
+	const unsigned long ms = waitTime();
+	if (ms > 0) {
+		_wakeup.sleep(ms < maxSleepMs ? ms : maxSleepMs);
+	}
+	_wakeup.unlock();
+	return processAll();
+}
+
+// Gets the due time (in millis()) of the earliest message; returns false if there is no message.
+template <unsigned int C, CollectionErrorHandler E>
+bool MessageLoop<C, E>::nextDeadline(unsigned long& tick) const {
+	Lock lock(_wakeup);
+	const typename Queue::Handle handle = _messages.peekHandle();
+	if (handle == Queue::NO_HANDLE) {
+		return false;
+	}
+	tick = _messages[handle].tick;
+	return true;
+}
+
+// The number of milliseconds until the earliest message is due, 0 if it is overdue, or NO_DEADLINE if
+// there is no message.
+template <unsigned int C, CollectionErrorHandler E>
+unsigned long MessageLoop<C, E>::timeUntilNext() const {
+	Lock lock(_wakeup);
+	return waitTime();
+}
+
+// Runs the earliest message if it is due at the given time. A message which returns a positive result is
+// rescheduled that many milliseconds later, otherwise it is dropped. The message leaves the queue while
+// it runs, so its callback can post even into an otherwise full loop; the repeat is then pushed again and
+// raises OutOfSpace (and is lost) only if the callback filled the loop up.
+template <unsigned int C, CollectionErrorHandler E>
+bool MessageLoop<C, E>::runNext(const unsigned long now) {
 	Message msg;
-	while (_messages.tryShift(msg)) {
-		if (msg.tick <= millis()) {
-			int result = msg.callbackFcn(msg.data);
-			if (result <= 0) {
-				break;
-			}
-			msg.tick = millis() + result;
+	{
+		Lock lock(_wakeup);
+		const typename Queue::Handle handle = _messages.peekHandle();
+		if (handle == Queue::NO_HANDLE || (long)(now - _messages[handle].tick) < 0) {
+			return false;
 		}
+		_messages.tryPop(msg);
+	}
+	int result = msg.callbackFcn(msg.data);
+	if (result > 0) {
+		Lock lock(_wakeup);
+		msg.tick = millis() + result;
+		msg.sequence = _sequence++;
 		_messages.push(msg);
-		break;
 	}
+	return true;
+}
+
+template <unsigned int C, CollectionErrorHandler E>
+unsigned long MessageLoop<C, E>::waitTime() const {
+	const typename Queue::Handle handle = _messages.peekHandle();
+	if (handle == Queue::NO_HANDLE) {
+		return NO_DEADLINE;
+	}
+	const long ms = (long)(_messages[handle].tick - millis());
+	return ms > 0 ? ms : 0;
 }
 
 #endif
\ No newline at end of file
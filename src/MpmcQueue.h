@@ -0,0 +1,198 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _MpmcQueue_H
+#define _MpmcQueue_H
+
+#include <Arduino.h>
+#include <utility>
+#include "CollectionError.h"
+#include "RawArray.h"
+
+// A bounded FIFO queue for any number of producers and consumers (Dmitry Vyukov's design).
+// Every slot carries a sequence number which tells whose turn it is: a producer may fill the slot
+// at position pos when the sequence equals pos, a consumer may empty it when it equals pos + 1.
+// Producers and consumers claim positions with a compare-and-swap and never wait on each other.
+template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class MpmcQueue {
+	static_assert(C >= 2 && (C & (C - 1)) == 0, "capacity must be a power of two");
+public:
+	MpmcQueue();
+	MpmcQueue(const MpmcQueue& other) = delete;
+	~MpmcQueue();
+	MpmcQueue& operator=(const MpmcQueue& other) = delete;
+	static constexpr size_t footprint();
+	unsigned int capacity() const;
+	unsigned int size() const;
+	bool isEmpty() const;
+	bool tryPush(const T& value);
+	bool tryPush(T&& value);
+	template<typename... Args>
+	bool tryEmplace(Args&&... args);
+	unsigned int tryPushBulk(const T* values, const unsigned int count);
+	bool tryPop(T& value);
+	unsigned int tryPopBulk(T* values, const unsigned int count);
+private:
+#if defined(ARDUINO)
+	static constexpr size_t LINE = sizeof(unsigned int);
+#else
+	static constexpr size_t LINE = 64;
+#endif
+	static constexpr unsigned int MASK = C - 1;
+	alignas(LINE) unsigned int _enqueue;
+	alignas(LINE) unsigned int _dequeue;
+	alignas(LINE) unsigned int _sequence[C];
+	RawArray<T, C> _data;
+	unsigned int claim(unsigned int& counter, unsigned int& position, const unsigned int offset, const unsigned int count);
+};
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+MpmcQueue<T, C, E>::MpmcQueue(): _enqueue(0), _dequeue(0) {
+	for (unsigned int i = 0; i < C; i++) {
+		_sequence[i] = i;
+	}
+}
+
+// Not safe while a producer or consumer is active.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+MpmcQueue<T, C, E>::~MpmcQueue() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int i = _dequeue; i != _enqueue; i++) {
+			_data.destroy(i & MASK);
+		}
+	}
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t MpmcQueue<T, C, E>::footprint() {
+	return sizeof(MpmcQueue);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int MpmcQueue<T, C, E>::capacity() const {
+	return C;
+}
+
+// Only a snapshot while producers or consumers are active.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int MpmcQueue<T, C, E>::size() const {
+	const unsigned int dequeue = __atomic_load_n(&_dequeue, __ATOMIC_ACQUIRE);
+	const int size = (int)(__atomic_load_n(&_enqueue, __ATOMIC_ACQUIRE) - dequeue);
+	return size < 0 ? 0 : size > (int)C ? C : size;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool MpmcQueue<T, C, E>::isEmpty() const {
+	return size() == 0;
+}
+
+// Claims up to count consecutive positions of the given counter whose slots have the sequence
+// position + offset. Returns how many were claimed (0 when full or empty) and the first one in position.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int MpmcQueue<T, C, E>::claim(unsigned int& counter, unsigned int& position, const unsigned int offset, const unsigned int count) {
+	if (count == 0) {
+		return 0;
+	}
+	position = __atomic_load_n(&counter, __ATOMIC_RELAXED);
+	for (;;) {
+		unsigned int ready = 0;
+		int diff = 0;
+		while (ready < count) {
+			const unsigned int next = position + ready;
+			diff = (int)(__atomic_load_n(&_sequence[next & MASK], __ATOMIC_ACQUIRE) - (next + offset));
+			if (diff != 0) {
+				break;
+			}
+			ready++;
+		}
+		if (ready == 0 && diff < 0) {
+			return 0;
+		}
+		if (ready == 0) {
+			// another thread has claimed the position in the meantime
+			position = __atomic_load_n(&counter, __ATOMIC_RELAXED);
+		} else if (__atomic_compare_exchange_n(&counter, &position, position + ready, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return ready;
+		}
+	}
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool MpmcQueue<T, C, E>::tryPush(const T& value) {
+	return tryEmplace(value);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool MpmcQueue<T, C, E>::tryPush(T&& value) {
+	return tryEmplace(std::move(value));
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+template<typename... Args>
+bool MpmcQueue<T, C, E>::tryEmplace(Args&&... args) {
+	unsigned int position;
+	if (claim(_enqueue, position, 0, 1) == 0) {
+		return false;
+	}
+	_data.construct(position & MASK, std::forward<Args>(args)...);
+	__atomic_store_n(&_sequence[position & MASK], position + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+// Adds as many of the values as fit; if that is not all of them, OutOfSpace is raised after they were added.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int MpmcQueue<T, C, E>::tryPushBulk(const T* values, const unsigned int count) {
+	unsigned int position;
+	const unsigned int n = claim(_enqueue, position, 0, count);
+	for (unsigned int i = 0; i < n; i++) {
+		_data.construct((position + i) & MASK, values[i]);
+		__atomic_store_n(&_sequence[(position + i) & MASK], position + i + 1, __ATOMIC_RELEASE);
+	}
+	if (n < count) {
+		E(CollectionError::OutOfSpace);
+	}
+	return n;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool MpmcQueue<T, C, E>::tryPop(T& value) {
+	unsigned int position;
+	if (claim(_dequeue, position, 1, 1) == 0) {
+		return false;
+	}
+	value = std::move(_data[position & MASK]);
+	_data.destroy(position & MASK);
+	__atomic_store_n(&_sequence[position & MASK], position + C, __ATOMIC_RELEASE);
+	return true;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int MpmcQueue<T, C, E>::tryPopBulk(T* values, const unsigned int count) {
+	unsigned int position;
+	const unsigned int n = claim(_dequeue, position, 1, count);
+	for (unsigned int i = 0; i < n; i++) {
+		values[i] = std::move(_data[(position + i) & MASK]);
+		_data.destroy((position + i) & MASK);
+		__atomic_store_n(&_sequence[(position + i) & MASK], position + i + C, __ATOMIC_RELEASE);
+	}
+	return n;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,222 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _ObjectPool_H
+#define _ObjectPool_H
+
+#include <Arduino.h>
+#include <utility>
+#include "BitSet.h"
+#include "CollectionError.h"
+#include "IndexType.h"
+#include "RawArray.h"
+
+template<unsigned int C, bool STATS>
+class PoolStats {
+public:
+	PoolStats(): _peak(0) {}
+	inline void update(const unsigned int size) {
+		if (size > _peak) {
+			_peak = size;
+		}
+	}
+	inline unsigned int peak() const {
+		return _peak;
+	}
+	inline void reset(const unsigned int size) {
+		_peak = size;
+	}
+private:
+	IndexType<C> _peak;
+};
+
+template<unsigned int C>
+class PoolStats<C, false> {
+public:
+	inline void update(const unsigned int size) {}
+	inline unsigned int peak() const {
+		return 0;
+	}
+	inline void reset(const unsigned int size) {}
+};
+
+// Fixed storage for up to C objects of type T. Free slots are tracked in a BitSet, so allocation
+// takes the first clear bit and never touches the heap. With STATS the pool records its high-water mark.
+template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler, bool STATS = false>
+class ObjectPool {
+public:
+	// Owns one object of the pool and returns it when it goes out of scope.
+	class Handle {
+	public:
+		Handle(): _pool(nullptr), _object(nullptr) {}
+		Handle(ObjectPool* pool, T* object): _pool(pool), _object(object) {}
+		Handle(const Handle& other) = delete;
+		Handle(Handle&& other): _pool(other._pool), _object(other.detach()) {}
+		~Handle() { reset(); }
+		Handle& operator=(const Handle& other) = delete;
+		Handle& operator=(Handle&& other) {
+			if (this != &other) {
+				reset();
+				_pool = other._pool;
+				_object = other.detach();
+			}
+			return *this;
+		}
+		T* get() const { return _object; }
+		T* operator->() const { return _object; }
+		T& operator*() const { return *_object; }
+		explicit operator bool() const { return _object != nullptr; }
+		T* detach() {
+			T* object = _object;
+			_object = nullptr;
+			return object;
+		}
+		void reset() {
+			if (_object) {
+				_pool->release(_object);
+				_object = nullptr;
+			}
+		}
+	private:
+		ObjectPool* _pool;
+		T* _object;
+	};
+	ObjectPool();
+	ObjectPool(const ObjectPool& other) = delete;
+	~ObjectPool();
+	ObjectPool& operator=(const ObjectPool& other) = delete;
+	static constexpr size_t footprint();
+	unsigned int size() const;
+	unsigned int capacity() const;
+	bool isFull() const;
+	bool owns(const T* object) const;
+	template<typename... Args>
+	T* allocate(Args&&... args);
+	template<typename... Args>
+	Handle make(Args&&... args);
+	void release(T* object);
+	void clear();
+	unsigned int highWaterMark() const;
+	void resetHighWaterMark();
+private:
+	BitSet<C> _used;
+	RawArray<T, C> _entries;
+	IndexType<C> _size;
+	PoolStats<C, STATS> _stats;
+	unsigned int indexOf(const T* object) const;
+};
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+ObjectPool<T, C, E, STATS>::ObjectPool(): _size(0) {
+	_used.clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+ObjectPool<T, C, E, STATS>::~ObjectPool() {
+	clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+constexpr size_t ObjectPool<T, C, E, STATS>::footprint() {
+	return sizeof(ObjectPool);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline unsigned int ObjectPool<T, C, E, STATS>::size() const {
+	return _size;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline unsigned int ObjectPool<T, C, E, STATS>::capacity() const {
+	return C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline bool ObjectPool<T, C, E, STATS>::isFull() const {
+	return _size >= C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline unsigned int ObjectPool<T, C, E, STATS>::indexOf(const T* object) const {
+	const T* first = &_entries[0];
+	return object >= first && object < first + C ? object - first : C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline bool ObjectPool<T, C, E, STATS>::owns(const T* object) const {
+	const unsigned int index = indexOf(object);
+	return index < C && _used[index];
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+template<typename... Args>
+T* ObjectPool<T, C, E, STATS>::allocate(Args&&... args) {
+	const unsigned int index = _used.findFirstClear();
+	if (index >= C) {
+		E(CollectionError::OutOfSpace);
+		return nullptr;
+	}
+	_used.set(index);
+	_stats.update(++_size);
+	return &_entries.construct(index, std::forward<Args>(args)...);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+template<typename... Args>
+inline typename ObjectPool<T, C, E, STATS>::Handle ObjectPool<T, C, E, STATS>::make(Args&&... args) {
+	return Handle(this, allocate(std::forward<Args>(args)...));
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+void ObjectPool<T, C, E, STATS>::release(T* object) {
+	const unsigned int index = indexOf(object);
+	if (index >= C || !_used[index]) {
+		E(CollectionError::OutOfBound);
+		return;
+	}
+	_entries.destroy(index);
+	_used.unset(index);
+	_size--;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+void ObjectPool<T, C, E, STATS>::clear() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int index : _used.setBits()) {
+			_entries.destroy(index);
+		}
+	}
+	_used.clear();
+	_size = 0;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline unsigned int ObjectPool<T, C, E, STATS>::highWaterMark() const {
+	static_assert(STATS, "the pool does not keep statistics");
+	return _stats.peak();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E, bool STATS>
+inline void ObjectPool<T, C, E, STATS>::resetHighWaterMark() {
+	static_assert(STATS, "the pool does not keep statistics");
+	_stats.reset(_size);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,410 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _PriorityQueue_H
+#define _PriorityQueue_H
+
+#include <Arduino.h>
+#include <utility>
+#include "CollectionError.h"
+#include "Comparer.h"
+#include "IndexType.h"
+#include "RawArray.h"
+
+// A D-ary min-heap over fixed storage: the element for which S returns the lowest order is on top.
+// Elements stay in the slot they were added to and the heap only moves slot numbers around, so large
+// elements are never copied while sifting and every element can be addressed by a stable Handle
+// (its slot) until it is popped or removed. The slots past the end of the heap are the free ones.
+template<typename T, unsigned int C, Comparer<T> S = GenericComparer<T>, unsigned int D = 2, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class PriorityQueue {
+	static_assert(D >= 2, "the heap must be at least binary");
+public:
+	typedef IndexType<C> Handle;
+	static constexpr Handle NO_HANDLE = C;
+	static constexpr size_t footprint();
+	static constexpr size_t overhead();
+	static void heapify(T* data, const unsigned int size);
+	PriorityQueue();
+	PriorityQueue(const PriorityQueue& other);
+	~PriorityQueue();
+	PriorityQueue& operator=(const PriorityQueue& other);
+	unsigned int capacity() const;
+	unsigned int size() const;
+	bool isFull() const;
+	bool isEmpty() const;
+	bool contains(const Handle handle) const;
+	const T& operator[](const Handle handle) const;
+	Handle push(const T& value);
+	Handle push(T&& value);
+	template<typename... Args>
+	Handle emplace(Args&&... args);
+	unsigned int pushBulk(const T* values, const unsigned int count);
+	T pop();
+	bool tryPop(T& value);
+	T peek() const;
+	bool tryPeek(T& value) const;
+	Handle peekHandle() const;
+	void decreaseKey(const Handle handle, const T& value);
+	void update(const Handle handle, const T& value);
+	void remove(const Handle handle);
+	void clear();
+private:
+	RawArray<T, C> _data;
+	Handle _heap[C];
+	Handle _position[C];
+	Handle _size;
+	void siftUp(unsigned int position);
+	void siftDown(unsigned int position);
+	void place(const unsigned int position, const Handle slot);
+	void removeAt(const unsigned int position);
+	void reset();
+	static void siftDown(T* data, const unsigned int size, unsigned int position);
+	bool assertValidHandle(const Handle handle) const;
+	bool assertNotEmpty() const;
+	bool assertNotFull() const;
+};
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+constexpr typename PriorityQueue<T, C, S, D, E>::Handle PriorityQueue<T, C, S, D, E>::NO_HANDLE;
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+constexpr size_t PriorityQueue<T, C, S, D, E>::footprint() {
+	return sizeof(PriorityQueue);
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+constexpr size_t PriorityQueue<T, C, S, D, E>::overhead() {
+	return sizeof(PriorityQueue) - sizeof(T) * C;
+}
+
+// Rearranges the given buffer into a heap in place in O(n) (Floyd's method), so that data[0] is on top.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::heapify(T* data, const unsigned int size) {
+	for (unsigned int i = size / D + 1; i-- > 0; ) {
+		siftDown(data, size, i);
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+PriorityQueue<T, C, S, D, E>::PriorityQueue(): _size(0) {
+	reset();
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+PriorityQueue<T, C, S, D, E>::PriorityQueue(const PriorityQueue& other): _size(0) {
+	reset();
+	*this = other;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+PriorityQueue<T, C, S, D, E>::~PriorityQueue() {
+	clear();
+}
+
+// The copy uses the same slots, so handles of the original are valid for the copy as well.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+PriorityQueue<T, C, S, D, E>& PriorityQueue<T, C, S, D, E>::operator=(const PriorityQueue& other) {
+	if (this != &other) {
+		clear();
+		for (unsigned int i = 0; i < other._size; i++) {
+			_data.construct(other._heap[i], other._data[other._heap[i]]);
+		}
+		memcpy(_heap, other._heap, sizeof(_heap));
+		memcpy(_position, other._position, sizeof(_position));
+		_size = other._size;
+	}
+	return *this;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline unsigned int PriorityQueue<T, C, S, D, E>::capacity() const {
+	return C;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline unsigned int PriorityQueue<T, C, S, D, E>::size() const {
+	return _size;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline bool PriorityQueue<T, C, S, D, E>::isFull() const {
+	return _size == C;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline bool PriorityQueue<T, C, S, D, E>::isEmpty() const {
+	return _size == 0;
+}
+
+// A handle stays valid until its element is popped or removed; afterwards the slot may be reused.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline bool PriorityQueue<T, C, S, D, E>::contains(const Handle handle) const {
+	return handle < C && _position[handle] < _size;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline const T& PriorityQueue<T, C, S, D, E>::operator[](const Handle handle) const {
+	assertValidHandle(handle);
+	return _data[handle];
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline typename PriorityQueue<T, C, S, D, E>::Handle PriorityQueue<T, C, S, D, E>::push(const T& value) {
+	return emplace(value);
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline typename PriorityQueue<T, C, S, D, E>::Handle PriorityQueue<T, C, S, D, E>::push(T&& value) {
+	return emplace(std::move(value));
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+template<typename... Args>
+typename PriorityQueue<T, C, S, D, E>::Handle PriorityQueue<T, C, S, D, E>::emplace(Args&&... args) {
+	if (!assertNotFull()) {
+		return NO_HANDLE;
+	}
+	const Handle slot = _heap[_size];
+	_data.construct(slot, std::forward<Args>(args)...);
+	siftUp(_size++);
+	return slot;
+}
+
+// Adds up to count values and returns how many were added. Larger batches are added unordered and
+// the heap is then rebuilt in O(n) instead of sifting every value up on its own.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+unsigned int PriorityQueue<T, C, S, D, E>::pushBulk(const T* values, const unsigned int count) {
+	const unsigned int room = C - _size;
+	const unsigned int n = count < room ? count : room;
+	if (n < _size) {
+		for (unsigned int i = 0; i < n; i++) {
+			push(values[i]);
+		}
+	} else {
+		for (unsigned int i = 0; i < n; i++) {
+			_data.construct(_heap[_size++], values[i]);
+		}
+		for (unsigned int i = _size / D + 1; i-- > 0; ) {
+			siftDown(i);
+		}
+	}
+	if (n < count) {
+		E(CollectionError::OutOfSpace);
+	}
+	return n;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+T PriorityQueue<T, C, S, D, E>::pop() {
+	T value = T();
+	tryPop(value);
+	return value;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+bool PriorityQueue<T, C, S, D, E>::tryPop(T& value) {
+	if (!assertNotEmpty()) {
+		return false;
+	}
+	value = std::move(_data[_heap[0]]);
+	removeAt(0);
+	return true;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+T PriorityQueue<T, C, S, D, E>::peek() const {
+	if (!assertNotEmpty()) {
+		return T();
+	}
+	return _data[_heap[0]];
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+bool PriorityQueue<T, C, S, D, E>::tryPeek(T& value) const {
+	if (_size == 0) {
+		return false;
+	}
+	value = _data[_heap[0]];
+	return true;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline typename PriorityQueue<T, C, S, D, E>::Handle PriorityQueue<T, C, S, D, E>::peekHandle() const {
+	return _size > 0 ? _heap[0] : NO_HANDLE;
+}
+
+// Replaces the value of an element with one which does not order after it and moves it up accordingly.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::decreaseKey(const Handle handle, const T& value) {
+	if (assertValidHandle(handle)) {
+		_data[handle] = value;
+		siftUp(_position[handle]);
+	}
+}
+
+// Replaces the value of an element and moves it up or down accordingly.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::update(const Handle handle, const T& value) {
+	if (assertValidHandle(handle)) {
+		const bool up = S(value, _data[handle]) < 0;
+		_data[handle] = value;
+		if (up) {
+			siftUp(_position[handle]);
+		} else {
+			siftDown(_position[handle]);
+		}
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::remove(const Handle handle) {
+	if (assertValidHandle(handle)) {
+		removeAt(_position[handle]);
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::clear() {
+	for (unsigned int i = 0; i < _size; i++) {
+		_data.destroy(_heap[i]);
+	}
+	_size = 0;
+	reset();
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::siftUp(unsigned int position) {
+	const Handle slot = _heap[position];
+	while (position > 0) {
+		const unsigned int parent = (position - 1) / D;
+		if (S(_data[slot], _data[_heap[parent]]) >= 0) {
+			break;
+		}
+		place(position, _heap[parent]);
+		position = parent;
+	}
+	place(position, slot);
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::siftDown(unsigned int position) {
+	const Handle slot = _heap[position];
+	for (;;) {
+		const unsigned int first = position * D + 1;
+		if (first >= _size) {
+			break;
+		}
+		const unsigned int last = first + D < _size ? first + D : _size;
+		unsigned int best = first;
+		for (unsigned int i = first + 1; i < last; i++) {
+			if (S(_data[_heap[i]], _data[_heap[best]]) < 0) {
+				best = i;
+			}
+		}
+		if (S(_data[_heap[best]], _data[slot]) >= 0) {
+			break;
+		}
+		place(position, _heap[best]);
+		position = best;
+	}
+	place(position, slot);
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+inline void PriorityQueue<T, C, S, D, E>::place(const unsigned int position, const Handle slot) {
+	_heap[position] = slot;
+	_position[slot] = position;
+}
+
+// Moves the last element of the heap into the hole and parks the freed slot right after the heap.
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::removeAt(const unsigned int position) {
+	const Handle slot = _heap[position];
+	const unsigned int last = --_size;
+	_data.destroy(slot);
+	if (position != last) {
+		place(position, _heap[last]);
+		place(last, slot);
+		if (position > 0 && S(_data[_heap[position]], _data[_heap[(position - 1) / D]]) < 0) {
+			siftUp(position);
+		} else {
+			siftDown(position);
+		}
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::reset() {
+	for (unsigned int i = 0; i < C; i++) {
+		_heap[i] = i;
+		_position[i] = i;
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+void PriorityQueue<T, C, S, D, E>::siftDown(T* data, const unsigned int size, unsigned int position) {
+	for (;;) {
+		const unsigned int first = position * D + 1;
+		if (first >= size) {
+			return;
+		}
+		const unsigned int last = first + D < size ? first + D : size;
+		unsigned int best = first;
+		for (unsigned int i = first + 1; i < last; i++) {
+			if (S(data[i], data[best]) < 0) {
+				best = i;
+			}
+		}
+		if (S(data[best], data[position]) >= 0) {
+			return;
+		}
+		std::swap(data[position], data[best]);
+		position = best;
+	}
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+bool PriorityQueue<T, C, S, D, E>::assertValidHandle(const Handle handle) const {
+	if (contains(handle)) {
+		return true;
+	}
+	E(CollectionError::OutOfBound);
+	return false;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+bool PriorityQueue<T, C, S, D, E>::assertNotEmpty() const {
+	if (_size > 0) {
+		return true;
+	}
+	E(CollectionError::IsEmpty);
+	return false;
+}
+
+template<typename T, unsigned int C, Comparer<T> S, unsigned int D, CollectionErrorHandler E>
+bool PriorityQueue<T, C, S, D, E>::assertNotFull() const {
+	if (_size < C) {
+		return true;
+	}
+	E(CollectionError::OutOfSpace);
+	return false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _RankSelectBitSet_H
+#define _RankSelectBitSet_H
+
+#include <Arduino.h>
+#include "BitSet.h"
+#include "CollectionError.h"
+#include "IndexType.h"
+
+template<unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class RankSelectBitSet {
+public:
+	RankSelectBitSet();
+	static constexpr size_t footprint();
+	unsigned int size() const;
+	unsigned int count() const;
+	bool operator [](const unsigned int i) const;
+	void set(const unsigned int i);
+	void unset(const unsigned int i);
+	void clear();
+	unsigned int rank(const unsigned int i) const;
+	unsigned int select(unsigned int k) const;
+	const BitSet<C, E>& bits() const;
+private:
+	typedef BitSet<C, E> Bits;
+	typedef typename Bits::Word Word;
+	// the directory holds the number of set bits before each block of 128 bits
+	static constexpr unsigned int BLOCK_WORDS = 128 / Bits::BITS;
+	static constexpr unsigned int BLOCKS = (Bits::WORDS + BLOCK_WORDS - 1) / BLOCK_WORDS;
+	Bits _bits;
+	IndexType<C> _ranks[BLOCKS];
+	IndexType<C> _count;
+	void adjust(const unsigned int i, const int delta);
+};
+
+template<unsigned int C, CollectionErrorHandler E>
+RankSelectBitSet<C, E>::RankSelectBitSet() {
+	clear();
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+constexpr size_t RankSelectBitSet<C, E>::footprint() {
+	return sizeof(RankSelectBitSet);
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int RankSelectBitSet<C, E>::size() const {
+	return C;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline unsigned int RankSelectBitSet<C, E>::count() const {
+	return _count;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline bool RankSelectBitSet<C, E>::operator[](const unsigned int i) const {
+	return _bits[i];
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void RankSelectBitSet<C, E>::set(const unsigned int i) {
+	if (i < C && !_bits[i]) {
+		_bits.set(i);
+		adjust(i, 1);
+	} else if (i >= C) {
+		E(CollectionError::OutOfBound);
+	}
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void RankSelectBitSet<C, E>::unset(const unsigned int i) {
+	if (i < C && _bits[i]) {
+		_bits.unset(i);
+		adjust(i, -1);
+	} else if (i >= C) {
+		E(CollectionError::OutOfBound);
+	}
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void RankSelectBitSet<C, E>::adjust(const unsigned int i, const int delta) {
+	for (unsigned int block = i / Bits::BITS / BLOCK_WORDS + 1; block < BLOCKS; block++) {
+		_ranks[block] += delta;
+	}
+	_count += delta;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+void RankSelectBitSet<C, E>::clear() {
+	_bits.clear();
+	memset(&_ranks[0], 0, sizeof(_ranks));
+	_count = 0;
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+unsigned int RankSelectBitSet<C, E>::rank(const unsigned int i) const {
+	if (i >= C) {
+		if (i > C) {
+			E(CollectionError::OutOfBound);
+		}
+		return _count;
+	}
+	const unsigned int w = i / Bits::BITS;
+	unsigned int result = _ranks[w / BLOCK_WORDS];
+	for (unsigned int j = w - w % BLOCK_WORDS; j < w; j++) {
+		result += __builtin_popcount(_bits._data[j]);
+	}
+	return result + __builtin_popcount(_bits._data[w] & (Word)~(Bits::ALL << (i & Bits::MASK)));
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+unsigned int RankSelectBitSet<C, E>::select(unsigned int k) const {
+	if (k >= _count) {
+		return C;
+	}
+	unsigned int low = 0;
+	unsigned int high = BLOCKS - 1;
+	while (low < high) {
+		const unsigned int mid = (low + high + 1) / 2;
+		if (_ranks[mid] <= k) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+	k -= _ranks[low];
+	for (unsigned int w = low * BLOCK_WORDS; ; w++) {
+		Word word = _bits._data[w];
+		const unsigned int bits = __builtin_popcount(word);
+		if (k < bits) {
+			for (; k > 0; k--) {
+				word &= word - 1;
+			}
+			return w * Bits::BITS + __builtin_ctz(word);
+		}
+		k -= bits;
+	}
+}
+
+template<unsigned int C, CollectionErrorHandler E>
+inline const BitSet<C, E>& RankSelectBitSet<C, E>::bits() const {
+	return _bits;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _RawArray_H
+#define _RawArray_H
+
+#include <Arduino.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Uninitialized, suitably aligned storage for C elements of type T. Elements
+// are only constructed and destroyed on request, so the owning collection has
+// to keep track of which slots are live. Trivially copyable types are shifted
+// with memmove, and destroying trivially destructible types is a no-op.
+template<typename T, unsigned int C>
+class RawArray {
+public:
+	static constexpr bool TRIVIAL_COPY = std::is_trivially_copyable<T>::value;
+	static constexpr bool TRIVIAL_DESTROY = std::is_trivially_destructible<T>::value;
+	RawArray() {}
+	RawArray(const RawArray& other) = delete;
+	RawArray& operator=(const RawArray& other) = delete;
+	T& operator[](const unsigned int index);
+	const T& operator[](const unsigned int index) const;
+	template<typename... Args>
+	T& construct(const unsigned int index, Args&&... args);
+	void destroy(const unsigned int index);
+	void destroy(const unsigned int from, const unsigned int to);
+	void openGap(const unsigned int index, const unsigned int size);
+	void closeGap(const unsigned int index, const unsigned int size);
+private:
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type _data[C];
+};
+
+template<typename T, unsigned int C>
+inline T& RawArray<T, C>::operator[](const unsigned int index) {
+	return *reinterpret_cast<T*>(&_data[index]);
+}
+
+template<typename T, unsigned int C>
+inline const T& RawArray<T, C>::operator[](const unsigned int index) const {
+	return *reinterpret_cast<const T*>(&_data[index]);
+}
+
+template<typename T, unsigned int C>
+template<typename... Args>
+inline T& RawArray<T, C>::construct(const unsigned int index, Args&&... args) {
+	return *new (&_data[index]) T(std::forward<Args>(args)...);
+}
+
+template<typename T, unsigned int C>
+inline void RawArray<T, C>::destroy(const unsigned int index) {
+	(*this)[index].~T();
+}
+
+template<typename T, unsigned int C>
+void RawArray<T, C>::destroy(const unsigned int from, const unsigned int to) {
+	if (!TRIVIAL_DESTROY) {
+		for (unsigned int i = from; i < to; i++) {
+			destroy(i);
+		}
+	}
+}
+
+// Shifts the live slots [index, size) up by one, leaving the slot at index uninitialized.
+template<typename T, unsigned int C>
+void RawArray<T, C>::openGap(const unsigned int index, const unsigned int size) {
+	if (TRIVIAL_COPY) {
+		memmove(&_data[index + 1], &_data[index], (size - index) * sizeof(T));
+	} else if (index < size) {
+		construct(size, std::move((*this)[size - 1]));
+		for (unsigned int i = size - 1; i > index; i--) {
+			(*this)[i] = std::move((*this)[i - 1]);
+		}
+		destroy(index);
+	}
+}
+
+// Shifts the live slots (index, size) down by one onto the uninitialized slot
+// at index, leaving the slot at size - 1 uninitialized.
+template<typename T, unsigned int C>
+void RawArray<T, C>::closeGap(const unsigned int index, const unsigned int size) {
+	if (TRIVIAL_COPY) {
+		memmove(&_data[index], &_data[index + 1], (size - index - 1) * sizeof(T));
+	} else if (index + 1 < size) {
+		construct(index, std::move((*this)[index + 1]));
+		for (unsigned int i = index + 1; i + 1 < size; i++) {
+			(*this)[i] = std::move((*this)[i + 1]);
+		}
+		destroy(size - 1);
+	}
+}
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _RingLog_H
+#define _RingLog_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "CollectionError.h"
+#include "IndexType.h"
+#include "RawArray.h"
+
+// A ring of the last C entries where push never fails: once full, the oldest entry is overwritten.
+// Every entry gets a sequence number, which is also stored in its slot before the entry is written.
+// Readers (which may interrupt the writer or run on another core) copy an entry and then check that
+// the slot still holds the expected sequence number, so that they never block the writer and simply
+// skip entries which were overwritten while they were reading.
+template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class RingLog {
+	static_assert(C > 0 && (C & (C - 1)) == 0, "capacity must be a power of two");
+	static_assert(std::is_trivially_copyable<T>::value, "entries must be trivially copyable");
+public:
+	RingLog();
+	RingLog(const RingLog& other) = delete;
+	RingLog& operator=(const RingLog& other) = delete;
+	static constexpr size_t footprint();
+	unsigned int capacity() const;
+	unsigned int size() const;
+	bool isEmpty() const;
+	uint32_t push(const T& value);
+	uint32_t firstSequence() const;
+	uint32_t nextSequence() const;
+	bool tryGet(const uint32_t sequence, T& value) const;
+	unsigned int readSince(uint32_t& sequence, T* values, const unsigned int count) const;
+	unsigned int snapshot(T* values, const unsigned int count) const;
+	void clear();
+private:
+	static constexpr unsigned int MASK = C - 1;
+	RawArray<T, C> _data;
+	uint32_t _stamps[C];
+	uint32_t _next;
+	IndexType<C> _size;
+	bool read(const uint32_t sequence, T& value) const;
+};
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+RingLog<T, C, E>::RingLog() {
+	clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t RingLog<T, C, E>::footprint() {
+	return sizeof(RingLog);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int RingLog<T, C, E>::capacity() const {
+	return C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int RingLog<T, C, E>::size() const {
+	return __atomic_load_n(&_size, __ATOMIC_RELAXED);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool RingLog<T, C, E>::isEmpty() const {
+	return size() == 0;
+}
+
+// Returns the sequence number of the new entry.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+uint32_t RingLog<T, C, E>::push(const T& value) {
+	const uint32_t sequence = _next;
+	const unsigned int slot = sequence & MASK;
+	__atomic_store_n(&_stamps[slot], sequence, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	_data.construct(slot, value);
+	if (_size < C) {
+		__atomic_store_n(&_size, _size + 1, __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&_next, sequence + 1, __ATOMIC_RELEASE);
+	return sequence;
+}
+
+// The sequence number of the oldest entry still held.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline uint32_t RingLog<T, C, E>::firstSequence() const {
+	const uint32_t next = nextSequence();
+	return next - size();
+}
+
+// The sequence number the next entry will get.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline uint32_t RingLog<T, C, E>::nextSequence() const {
+	return __atomic_load_n(&_next, __ATOMIC_ACQUIRE);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool RingLog<T, C, E>::read(const uint32_t sequence, T& value) const {
+	const unsigned int slot = sequence & MASK;
+	if (__atomic_load_n(&_stamps[slot], __ATOMIC_ACQUIRE) != sequence) {
+		return false;
+	}
+	memcpy((void*)&value, &_data[slot], sizeof(T));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&_stamps[slot], __ATOMIC_RELAXED) == sequence;
+}
+
+// Copies the entry with the given sequence number, if it has been written and not overwritten yet.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool RingLog<T, C, E>::tryGet(const uint32_t sequence, T& value) const {
+	const uint32_t next = nextSequence();
+	if ((int32_t)(next - sequence) <= 0 || next - sequence > size()) {
+		return false;
+	}
+	return read(sequence, value);
+}
+
+// Copies up to count entries starting at the given sequence number, skipping the ones which have
+// been overwritten, and advances sequence past the last one read. A gap between the old and the new
+// value of sequence which is larger than the returned count means that entries were lost.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int RingLog<T, C, E>::readSince(uint32_t& sequence, T* values, const unsigned int count) const {
+	const uint32_t next = nextSequence();
+	const int32_t pending = (int32_t)(next - sequence);
+	if (pending < 0) {
+		sequence = next;
+	} else if ((uint32_t)pending > size()) {
+		sequence = next - size();
+	}
+	unsigned int n = 0;
+	while (n < count && sequence != next) {
+		if (read(sequence, values[n])) {
+			n++;
+		}
+		sequence++;
+	}
+	return n;
+}
+
+// Copies the newest entries (up to count, oldest first).
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int RingLog<T, C, E>::snapshot(T* values, const unsigned int count) const {
+	const unsigned int available = size();
+	uint32_t sequence = nextSequence() - (count < available ? count : available);
+	return readSince(sequence, values, count);
+}
+
+// Not safe while a reader is active.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void RingLog<T, C, E>::clear() {
+	for (unsigned int i = 0; i < C; i++) {
+		_stamps[i] = i - C;
+	}
+	_next = 0;
+	_size = 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _SlidingWindow_H
+#define _SlidingWindow_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "CollectionError.h"
+#include "Deque.h"
+#include "IndexType.h"
+
+// Keeps the last C samples (optionally also limited by age) and maintains their sum, mean, variance,
+// minimum and maximum in constant amortized time per sample. Mean and variance are kept with Welford's
+// updates in the floating point type A, which avoid the cancellation of a sum of squares; since adding
+// and removing samples forever still accumulates rounding errors, both are recomputed from the samples
+// after every C evictions.
+// Minimum and maximum are tracked with monotonic deques: each holds the samples which can still become
+// the extreme of the window, in window order, so the current extreme is always the oldest of them.
+template<typename T, unsigned int C, typename A = double, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class SlidingWindow {
+	static_assert(std::is_floating_point<A>::value, "the aggregate type must be a floating point type");
+public:
+	SlidingWindow();
+	static constexpr size_t footprint();
+	unsigned int capacity() const;
+	unsigned int size() const;
+	bool isEmpty() const;
+	bool isFull() const;
+	const T& operator[](const unsigned int index) const;
+	unsigned long timeOf(const unsigned int index) const;
+	void push(const T& value, const unsigned long time = 0);
+	void evict();
+	void evictBefore(const unsigned long time);
+	A sum() const;
+	A mean() const;
+	A variance() const;
+	T min() const;
+	T max() const;
+	void clear();
+private:
+	struct Sample {
+		T value;
+		unsigned long time;
+	};
+	struct Extreme {
+		T value;
+		uint32_t sequence;
+	};
+	Deque<Sample, C, E> _samples;
+	Deque<Extreme, C, E> _mins;
+	Deque<Extreme, C, E> _maxs;
+	uint32_t _sequence;
+	IndexType<C> _evictions;
+	A _mean;
+	A _m2;
+	void recompute();
+	bool assertNotEmpty() const;
+};
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+SlidingWindow<T, C, A, E>::SlidingWindow(): _sequence(0), _evictions(0), _mean(0), _m2(0) {
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+constexpr size_t SlidingWindow<T, C, A, E>::footprint() {
+	return sizeof(SlidingWindow);
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline unsigned int SlidingWindow<T, C, A, E>::capacity() const {
+	return C;
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline unsigned int SlidingWindow<T, C, A, E>::size() const {
+	return _samples.size();
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline bool SlidingWindow<T, C, A, E>::isEmpty() const {
+	return _samples.isEmpty();
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline bool SlidingWindow<T, C, A, E>::isFull() const {
+	return _samples.isFull();
+}
+
+// Index 0 is the oldest sample in the window.
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline const T& SlidingWindow<T, C, A, E>::operator[](const unsigned int index) const {
+	return _samples[index].value;
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline unsigned long SlidingWindow<T, C, A, E>::timeOf(const unsigned int index) const {
+	return _samples[index].time;
+}
+
+// Adds a sample, evicting the oldest one if the window is full.
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+void SlidingWindow<T, C, A, E>::push(const T& value, const unsigned long time) {
+	if (_samples.isFull()) {
+		evict();
+	}
+	_samples.push(Sample { value, time });
+	const A delta = (A)value - _mean;
+	_mean += delta / (A)_samples.size();
+	_m2 += delta * ((A)value - _mean);
+	while (!_mins.isEmpty() && !(_mins[_mins.size() - 1].value < value)) {
+		_mins.pop();
+	}
+	_mins.push(Extreme { value, _sequence });
+	while (!_maxs.isEmpty() && !(value < _maxs[_maxs.size() - 1].value)) {
+		_maxs.pop();
+	}
+	_maxs.push(Extreme { value, _sequence });
+	_sequence++;
+}
+
+// Removes the oldest sample.
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+void SlidingWindow<T, C, A, E>::evict() {
+	if (!assertNotEmpty()) {
+		return;
+	}
+	const uint32_t sequence = _sequence - _samples.size();
+	const unsigned int n = _samples.size();
+	if (n == 1) {
+		_mean = 0;
+		_m2 = 0;
+	} else {
+		const A value = (A)_samples[0].value;
+		const A delta = value - _mean;
+		_mean -= delta / (A)(n - 1);
+		_m2 -= delta * (value - _mean);
+	}
+	if (_mins[0].sequence == sequence) {
+		_mins.consume(1);
+	}
+	if (_maxs[0].sequence == sequence) {
+		_maxs.consume(1);
+	}
+	_samples.consume(1);
+	if (++_evictions >= C) {
+		recompute();
+	}
+}
+
+// Removes all samples with a time before the given one (millis() wraparound safe).
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+void SlidingWindow<T, C, A, E>::evictBefore(const unsigned long time) {
+	while (!_samples.isEmpty() && (long)(time - _samples[0].time) > 0) {
+		evict();
+	}
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline A SlidingWindow<T, C, A, E>::sum() const {
+	return _mean * (A)_samples.size();
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+A SlidingWindow<T, C, A, E>::mean() const {
+	if (assertNotEmpty()) {
+		return _mean;
+	}
+	return 0;
+}
+
+// The population variance of the samples in the window.
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+A SlidingWindow<T, C, A, E>::variance() const {
+	if (assertNotEmpty()) {
+		return _m2 > 0 ? _m2 / (A)_samples.size() : 0;
+	}
+	return 0;
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+T SlidingWindow<T, C, A, E>::min() const {
+	if (assertNotEmpty()) {
+		return _mins[0].value;
+	}
+	return T();
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+T SlidingWindow<T, C, A, E>::max() const {
+	if (assertNotEmpty()) {
+		return _maxs[0].value;
+	}
+	return T();
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+void SlidingWindow<T, C, A, E>::clear() {
+	_samples.clear();
+	_mins.clear();
+	_maxs.clear();
+	_evictions = 0;
+	_mean = 0;
+	_m2 = 0;
+}
+
+// Replaces the running mean and variance by exact two-pass values over the samples.
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+void SlidingWindow<T, C, A, E>::recompute() {
+	const unsigned int n = _samples.size();
+	_evictions = 0;
+	_mean = 0;
+	_m2 = 0;
+	if (n == 0) {
+		return;
+	}
+	A sum = 0;
+	for (unsigned int i = 0; i < n; i++) {
+		sum += (A)_samples[i].value;
+	}
+	_mean = sum / (A)n;
+	for (unsigned int i = 0; i < n; i++) {
+		const A delta = (A)_samples[i].value - _mean;
+		_m2 += delta * delta;
+	}
+}
+
+template<typename T, unsigned int C, typename A, CollectionErrorHandler E>
+inline bool SlidingWindow<T, C, A, E>::assertNotEmpty() const {
+	if (_samples.isEmpty()) {
+		E(CollectionError::IsEmpty);
+		return false;
+	}
+	return true;
+}
+
+#endif
\ No newline at end of file
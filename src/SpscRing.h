@@ -0,0 +1,202 @@
+/*
+ * Fixed-Size Collections for Arduino
+ *
+ * Copyright (c) 2017 Arsène von Wyss. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA * 
+ */
+
+#ifndef _SpscRing_H
+#define _SpscRing_H
+
+#include <Arduino.h>
+#include <utility>
+#include "CollectionError.h"
+#include "RawArray.h"
+
+// A FIFO queue for exactly one producer (e.g. an interrupt handler) and one consumer (e.g. loop()),
+// which may run concurrently without locks. The producer only writes _head and the consumer only
+// writes _tail; both are free-running counters published with release stores and read with acquire
+// loads, so an element is fully constructed before the consumer can see it. Each side caches the last
+// index it read from the other side to avoid touching the other side's cache line on every call.
+template<typename T, unsigned int C, CollectionErrorHandler E = IgnoreCollectionErrorHandler>
+class SpscRing {
+	static_assert(C > 0 && (C & (C - 1)) == 0, "capacity must be a power of two");
+public:
+	SpscRing();
+	SpscRing(const SpscRing& other) = delete;
+	~SpscRing();
+	SpscRing& operator=(const SpscRing& other) = delete;
+	static constexpr size_t footprint();
+	unsigned int capacity() const;
+	unsigned int size() const;
+	bool isFull() const;
+	bool isEmpty() const;
+	bool push(const T& value);
+	bool push(T&& value);
+	template<typename... Args>
+	bool emplace(Args&&... args);
+	unsigned int pushBulk(const T* values, const unsigned int count);
+	bool tryShift(T& value);
+	unsigned int shiftBulk(T* values, const unsigned int count);
+	void clear();
+private:
+#if defined(ARDUINO)
+	static constexpr size_t LINE = sizeof(unsigned int);
+#else
+	static constexpr size_t LINE = 64;
+#endif
+	static constexpr unsigned int MASK = C - 1;
+	alignas(LINE) unsigned int _head;
+	unsigned int _tailCache;
+	alignas(LINE) unsigned int _tail;
+	unsigned int _headCache;
+	alignas(LINE) RawArray<T, C> _data;
+	unsigned int reserve(const unsigned int count);
+	unsigned int available(const unsigned int count);
+};
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+SpscRing<T, C, E>::SpscRing(): _head(0), _tailCache(0), _tail(0), _headCache(0) {
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+SpscRing<T, C, E>::~SpscRing() {
+	clear();
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+constexpr size_t SpscRing<T, C, E>::footprint() {
+	return sizeof(SpscRing);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int SpscRing<T, C, E>::capacity() const {
+	return C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int SpscRing<T, C, E>::size() const {
+	const unsigned int tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+	return __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - tail;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool SpscRing<T, C, E>::isFull() const {
+	return size() >= C;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool SpscRing<T, C, E>::isEmpty() const {
+	return size() == 0;
+}
+
+// Producer side: returns how many of count slots are free, refreshing the cached tail if needed.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int SpscRing<T, C, E>::reserve(const unsigned int count) {
+	const unsigned int head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+	unsigned int room = C - (head - _tailCache);
+	if (room < count) {
+		_tailCache = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+		room = C - (head - _tailCache);
+	}
+	return room < count ? room : count;
+}
+
+// Consumer side: returns how many of count elements are ready, refreshing the cached head if needed.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline unsigned int SpscRing<T, C, E>::available(const unsigned int count) {
+	const unsigned int tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+	unsigned int ready = _headCache - tail;
+	if (ready < count) {
+		_headCache = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+		ready = _headCache - tail;
+	}
+	return ready < count ? ready : count;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool SpscRing<T, C, E>::push(const T& value) {
+	return emplace(value);
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+inline bool SpscRing<T, C, E>::push(T&& value) {
+	return emplace(std::move(value));
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+template<typename... Args>
+bool SpscRing<T, C, E>::emplace(Args&&... args) {
+	if (reserve(1) == 0) {
+		E(CollectionError::OutOfSpace);
+		return false;
+	}
+	const unsigned int head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+	_data.construct(head & MASK, std::forward<Args>(args)...);
+	__atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int SpscRing<T, C, E>::pushBulk(const T* values, const unsigned int count) {
+	const unsigned int n = reserve(count);
+	const unsigned int head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+	for (unsigned int i = 0; i < n; i++) {
+		_data.construct((head + i) & MASK, values[i]);
+	}
+	__atomic_store_n(&_head, head + n, __ATOMIC_RELEASE);
+	if (n < count) {
+		E(CollectionError::OutOfSpace);
+	}
+	return n;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+bool SpscRing<T, C, E>::tryShift(T& value) {
+	if (available(1) == 0) {
+		return false;
+	}
+	const unsigned int tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+	value = std::move(_data[tail & MASK]);
+	_data.destroy(tail & MASK);
+	__atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+template<typename T, unsigned int C, CollectionErrorHandler E>
+unsigned int SpscRing<T, C, E>::shiftBulk(T* values, const unsigned int count) {
+	const unsigned int n = available(count);
+	const unsigned int tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+	for (unsigned int i = 0; i < n; i++) {
+		values[i] = std::move(_data[(tail + i) & MASK]);
+		_data.destroy((tail + i) & MASK);
+	}
+	__atomic_store_n(&_tail, tail + n, __ATOMIC_RELEASE);
+	return n;
+}
+
+// Not safe while a producer or consumer is active.
+template<typename T, unsigned int C, CollectionErrorHandler E>
+void SpscRing<T, C, E>::clear() {
+	if (!RawArray<T, C>::TRIVIAL_DESTROY) {
+		for (unsigned int i = _tail; i != _head; i++) {
+			_data.destroy(i & MASK);
+		}
+	}
+	_head = _tail = _tailCache = _headCache = 0;
+}
+
+#endif
\ No newline at end of file
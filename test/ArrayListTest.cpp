@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include "ArrayList.h"
+#include "Test.h"
+
+static void testEmptyIteration() {
+	ArrayList<String, 4> list;
+	unsigned int count = 0;
+	for (ArrayList<String, 4>::iterator it = list.begin(); it != list.end(); it++) {
+		count++;
+	}
+	for (ArrayList<String, 4>::reverse_iterator it = list.rbegin(); it != list.rend(); it++) {
+		count++;
+	}
+	CHECK(count == 0);
+}
+
+static void testIteration() {
+	ArrayList<String, 4> list;
+	list.add("first");
+	list.add("second");
+	String forward;
+	for (ArrayList<String, 4>::iterator it = list.begin(); it != list.end(); it++) {
+		forward += *it;
+	}
+	CHECK(forward == "firstsecond");
+	String backward;
+	for (ArrayList<String, 4>::reverse_iterator it = list.rbegin(); it != list.rend(); it++) {
+		backward += *it;
+	}
+	CHECK(backward == "secondfirst");
+}
+
+static void testFullReverseIteration() {
+	ArrayList<String, 2> list;
+	list.add("a");
+	list.add("b");
+	String backward;
+	for (ArrayList<String, 2>::reverse_iterator it = list.rbegin(); it != list.rend(); it++) {
+		backward += *it;
+	}
+	CHECK(backward == "ba");
+}
+
+int main() {
+	testEmptyIteration();
+	testIteration();
+	testFullReverseIteration();
+	return failures;
+}
@@ -0,0 +1,137 @@
+#include <Arduino.h>
+#include "AtomicBitSet.h"
+#include "Test.h"
+#include <thread>
+#include <vector>
+
+static const unsigned int THREADS = 4;
+static const unsigned int ROUNDS = 20000;
+static const unsigned int BITS = 64;
+
+// Every thread owns the bits i with i % THREADS == its number, so all threads share the same words.
+// A lost update from a non-atomic read-modify-write would show as an owned bit in the wrong state.
+static void testOwnedBits() {
+	AtomicBitSet<BITS> bits;
+	unsigned int lost[THREADS] = {};
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < THREADS; t++) {
+		threads.emplace_back([&bits, &lost, t] {
+			for (unsigned int round = 0; round < ROUNDS; round++) {
+				for (unsigned int i = t; i < BITS; i += THREADS) {
+					bits.set(i);
+				}
+				for (unsigned int i = t; i < BITS; i += THREADS) {
+					if (!bits[i]) {
+						lost[t]++;
+					}
+					bits.unset(i);
+				}
+				for (unsigned int i = t; i < BITS; i += THREADS) {
+					if (bits[i]) {
+						lost[t]++;
+					}
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (unsigned int t = 0; t < THREADS; t++) {
+		CHECK(lost[t] == 0);
+	}
+	for (unsigned int i = 0; i < BITS; i++) {
+		CHECK(!bits[i]);
+	}
+}
+
+// All threads claim and release the same bits; a bit may only be claimed by one thread at a time,
+// so the claims and releases must balance and no claim may find its bit taken over.
+static void testContendedBits() {
+	AtomicBitSet<BITS> bits;
+	unsigned int claims[THREADS] = {};
+	unsigned int releases[THREADS] = {};
+	unsigned int stolen[THREADS] = {};
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < THREADS; t++) {
+		threads.emplace_back([&, t] {
+			for (unsigned int round = 0; round < ROUNDS; round++) {
+				const unsigned int i = (round * 7 + t) % BITS;
+				if (bits.testAndSet(i)) {
+					continue;
+				}
+				claims[t]++;
+				if (!bits.testAndClear(i)) {
+					stolen[t]++;
+				} else {
+					releases[t]++;
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	unsigned int totalClaims = 0;
+	unsigned int totalReleases = 0;
+	for (unsigned int t = 0; t < THREADS; t++) {
+		CHECK(stolen[t] == 0);
+		totalClaims += claims[t];
+		totalReleases += releases[t];
+	}
+	CHECK(totalClaims > 0);
+	CHECK(totalClaims == totalReleases);
+	for (unsigned int i = 0; i < BITS; i++) {
+		CHECK(!bits[i]);
+	}
+}
+
+// Producers raise flags which a consumer drains a word at a time; every raised flag must be drained
+// exactly once.
+static void testDrain() {
+	AtomicBitSet<BITS> bits;
+	const unsigned int producers = THREADS - 1;
+	unsigned int raised[THREADS] = {};
+	unsigned int drained = 0;
+	bool done = false;
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < producers; t++) {
+		threads.emplace_back([&, t] {
+			for (unsigned int round = 0; round < ROUNDS; round++) {
+				if (!bits.testAndSet((round + t * 5) % BITS)) {
+					raised[t]++;
+				}
+			}
+		});
+	}
+	std::thread consumer([&] {
+		for (;;) {
+			const bool last = __atomic_load_n(&done, __ATOMIC_ACQUIRE);
+			for (unsigned int w = 0; w < bits.WORDS; w++) {
+				drained += __builtin_popcount(bits.fetchAndClearWord(w));
+			}
+			if (last) {
+				return;
+			}
+			std::this_thread::yield();
+		}
+	});
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	__atomic_store_n(&done, true, __ATOMIC_RELEASE);
+	consumer.join();
+	unsigned int total = 0;
+	for (unsigned int t = 0; t < producers; t++) {
+		total += raised[t];
+	}
+	CHECK(total > 0);
+	CHECK(drained == total);
+}
+
+int main() {
+	testOwnedBits();
+	testContendedBits();
+	testDrain();
+	return failures;
+}
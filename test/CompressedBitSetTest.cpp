@@ -0,0 +1,178 @@
+#include <Arduino.h>
+#include "BitSet.h"
+#include "CompressedBitSet.h"
+#include "Test.h"
+#include <cstdlib>
+
+static unsigned int outOfSpace = 0;
+static unsigned int outOfBound = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	} else if (error == CollectionError::OutOfBound) {
+		outOfBound++;
+	}
+}
+
+template<unsigned int C, class S>
+static void checkSame(const S& set, const BitSet<C>& expected) {
+	CHECK(set.count() == expected.count());
+	for (unsigned int i = 0; i < C; i++) {
+		CHECK(set[i] == expected[i]);
+	}
+	unsigned int i = set.findFirstSet();
+	CHECK(i == expected.findFirstSet());
+	while (i < C) {
+		const unsigned int next = set.findNextSet(i);
+		CHECK(next == expected.findNextSet(i));
+		i = next;
+	}
+	unsigned int count = 0;
+	for (unsigned int bit : set.setBits()) {
+		CHECK(expected[bit]);
+		count++;
+	}
+	CHECK(count == expected.count());
+}
+
+// Mostly short ranges, so that the chunks switch between arrays, runs and bitmaps, with an
+// occasional long one across several chunks.
+template<unsigned int C>
+static void randomRange(unsigned int& from, unsigned int& to) {
+	from = rand() % C;
+	const unsigned int length = rand() % 4 == 0 ? rand() % C : rand() % 40;
+	to = from + length < C ? from + length : C;
+}
+
+template<unsigned int C, class S>
+static void randomChange(S& set, BitSet<C>& expected) {
+	unsigned int from, to;
+	switch (rand() % 5) {
+		case 0:
+			from = rand() % C;
+			set.set(from);
+			expected.set(from);
+			break;
+		case 1:
+			from = rand() % C;
+			set.unset(from);
+			expected.unset(from);
+			break;
+		case 2:
+			randomRange<C>(from, to);
+			set.setRange(from, to);
+			expected.setRange(from, to);
+			break;
+		case 3:
+			randomRange<C>(from, to);
+			set.clearRange(from, to);
+			expected.clearRange(from, to);
+			break;
+		default:
+			// a scattered bit, which turns a run chunk into an array or bitmap
+			from = rand() % C;
+			set.set(from);
+			expected.set(from);
+			from = rand() % C;
+			set.unset(from);
+			expected.unset(from);
+			break;
+	}
+}
+
+// Compares every operation with a plain BitSet. The pool is large enough for any state of the
+// set, so there must never be an OutOfSpace error.
+template<unsigned int C, unsigned int B>
+static void testRandom() {
+	static const unsigned int POOL = ((C + B - 1) / B) * (B / 16) + B + 2;
+	CompressedBitSet<C, POOL, B, countErrors> set;
+	CompressedBitSet<C, POOL, B, countErrors> other;
+	BitSet<C> expected;
+	BitSet<C> otherExpected;
+	expected.clear();
+	otherExpected.clear();
+	for (unsigned int round = 0; round < 5000; round++) {
+		const unsigned int operation = rand() % 16;
+		if (operation < 10) {
+			randomChange(set, expected);
+		} else if (operation < 12) {
+			randomChange(other, otherExpected);
+		} else if (operation == 12) {
+			set |= other;
+			expected |= otherExpected;
+		} else if (operation == 13) {
+			set &= other;
+			expected &= otherExpected;
+		} else if (operation == 14) {
+			set.andNot(other);
+			expected.andNot(otherExpected);
+		} else {
+			set.optimize();
+		}
+		if (rand() % 500 == 0) {
+			set.clear();
+			expected.clear();
+		}
+		checkSame(set, expected);
+		CHECK(set.usedWords() <= POOL);
+	}
+	checkSame(other, otherExpected);
+	set.andNot(set);
+	CHECK(set.count() == 0 && set.findFirstSet() == C);
+	CHECK(outOfSpace == 0);
+	CHECK(outOfBound == 0);
+}
+
+// A pool far too small for the bits: every change within a chunk either succeeds or raises
+// OutOfSpace and leaves the set exactly as it was.
+template<unsigned int C, unsigned int B>
+static void testOutOfSpace() {
+	CompressedBitSet<C, 24, B, countErrors> set;
+	BitSet<C> expected;
+	expected.clear();
+	outOfSpace = 0;
+	for (unsigned int round = 0; round < 5000; round++) {
+		BitSet<C> changed = expected;
+		const unsigned int chunk = (rand() % C) / B;
+		const unsigned int end = (chunk + 1) * B < C ? (chunk + 1) * B : C;
+		const unsigned int from = chunk * B + rand() % (end - chunk * B);
+		const unsigned int to = from + 1 + rand() % (end - from);
+		const unsigned int before = outOfSpace;
+		switch (rand() % 4) {
+			case 0:
+				set.set(from);
+				changed.set(from);
+				break;
+			case 1:
+				set.unset(from);
+				changed.unset(from);
+				break;
+			case 2:
+				set.setRange(from, to);
+				changed.setRange(from, to);
+				break;
+			default:
+				set.clearRange(from, to);
+				changed.clearRange(from, to);
+				break;
+		}
+		if (outOfSpace == before) {
+			expected = changed;
+		}
+		checkSame(set, expected);
+		CHECK(set.usedWords() <= 24);
+	}
+	CHECK(outOfSpace > 0);
+	CHECK(outOfBound == 0);
+}
+
+int main() {
+	srand(1);
+	testRandom<1000, 128>();
+	testRandom<200, 16>();
+	testRandom<5000, 4096>();
+	testOutOfSpace<1000, 128>();
+	testOutOfSpace<300, 64>();
+	return failures;
+}
@@ -0,0 +1,216 @@
+#include <Arduino.h>
+#include "Deque.h"
+#include "Test.h"
+#include <cstdlib>
+#include <deque>
+
+static const unsigned int CAPACITY = 8;
+
+static unsigned int outOfSpace = 0;
+static unsigned int outOfBound = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	} else if (error == CollectionError::OutOfBound) {
+		outOfBound++;
+	}
+}
+
+typedef Deque<int, CAPACITY, countErrors> IntDeque;
+
+// The segments must cover the elements in order: the first one up to the end of the storage,
+// the second one from its start.
+static void checkSame(IntDeque& deque, const std::deque<int>& expected) {
+	CHECK(deque.size() == expected.size());
+	CHECK(deque.isEmpty() == expected.empty());
+	CHECK(deque.isFull() == (expected.size() == CAPACITY));
+	for (unsigned int i = 0; i < expected.size(); i++) {
+		CHECK(deque[i] == expected[i]);
+	}
+	const IntDeque::Segments readable = deque.readableSegments();
+	CHECK(readable.first.size + readable.second.size == expected.size());
+	for (unsigned int i = 0; i < readable.first.size; i++) {
+		CHECK(readable.first.data[i] == expected[i]);
+	}
+	for (unsigned int i = 0; i < readable.second.size; i++) {
+		CHECK(readable.second.data[i] == expected[readable.first.size + i]);
+	}
+	if (readable.second.size > 0) {
+		CHECK(readable.second.data < readable.first.data);
+	}
+	const IntDeque::Segments writable = deque.writableSegments();
+	CHECK(writable.first.size + writable.second.size == CAPACITY - expected.size());
+	if (writable.second.size > 0) {
+		CHECK(writable.second.data < writable.first.data);
+	}
+	unsigned int i = 0;
+	for (int value : deque) {
+		CHECK(i < expected.size() && value == expected[i]);
+		i++;
+	}
+	CHECK(i == expected.size());
+}
+
+// Moves the ring so that it starts at the given slot, with the given number of elements.
+static void placeAt(IntDeque& deque, std::deque<int>& expected, const unsigned int start, const unsigned int size) {
+	deque.clear();
+	expected.clear();
+	for (unsigned int i = 0; i < start; i++) {
+		deque.push(0);
+		deque.shift();
+	}
+	for (unsigned int i = 0; i < size; i++) {
+		deque.push(100 + i);
+		expected.push_back(100 + i);
+	}
+}
+
+// Every start slot and fill level, so that the bulk operations and segments cross the end of the
+// storage at every possible point.
+static void testWrapAround() {
+	IntDeque deque;
+	std::deque<int> expected;
+	outOfSpace = 0;
+	outOfBound = 0;
+	unsigned int expectedOutOfSpace = 0;
+	unsigned int expectedOutOfBound = 0;
+	int next = 1000;
+	for (unsigned int start = 0; start <= CAPACITY; start++) {
+		for (unsigned int size = 0; size <= CAPACITY; size++) {
+			for (unsigned int count = 0; count <= CAPACITY + 1; count++) {
+				// pushBulk adds as many as fit
+				placeAt(deque, expected, start, size);
+				int values[CAPACITY + 1];
+				for (unsigned int i = 0; i < count; i++) {
+					values[i] = next++;
+				}
+				const unsigned int room = CAPACITY - size;
+				const unsigned int pushed = deque.pushBulk(values, count);
+				CHECK(pushed == (count < room ? count : room));
+				expectedOutOfSpace += pushed < count ? 1 : 0;
+				expected.insert(expected.end(), values, values + pushed);
+				checkSame(deque, expected);
+
+				// shiftBulk takes as many as there are
+				placeAt(deque, expected, start, size);
+				int out[CAPACITY + 1];
+				const unsigned int shifted = deque.shiftBulk(out, count);
+				CHECK(shifted == (count < size ? count : size));
+				for (unsigned int i = 0; i < shifted; i++) {
+					CHECK(out[i] == expected.front());
+					expected.pop_front();
+				}
+				checkSame(deque, expected);
+
+				// writing a part of the free slots in place
+				placeAt(deque, expected, start, size);
+				IntDeque::Segments writable = deque.writableSegments();
+				for (unsigned int i = 0; i < count && i < room; i++) {
+					int& slot = i < writable.first.size ? writable.first.data[i] : writable.second.data[i - writable.first.size];
+					slot = next;
+					expected.push_back(next++);
+				}
+				deque.commitWrite(count);
+				if (count > room) {
+					expectedOutOfBound++;
+					expected.resize(size);
+				}
+				checkSame(deque, expected);
+
+				// consuming a part of the elements
+				placeAt(deque, expected, start, size);
+				deque.consume(count);
+				if (count > size) {
+					expectedOutOfBound++;
+				} else {
+					expected.erase(expected.begin(), expected.begin() + count);
+				}
+				checkSame(deque, expected);
+			}
+		}
+	}
+	CHECK(outOfSpace == expectedOutOfSpace);
+	CHECK(outOfBound == expectedOutOfBound);
+	placeAt(deque, expected, CAPACITY / 2, CAPACITY / 2);
+	(void)deque[CAPACITY / 2];
+	CHECK(outOfBound == expectedOutOfBound + 1);
+}
+
+// Random operations at both ends against a std::deque.
+static void testRandom() {
+	IntDeque deque;
+	std::deque<int> expected;
+	int next = 0;
+	for (unsigned int round = 0; round < 20000; round++) {
+		int value;
+		switch (rand() % 6) {
+			case 0:
+				if (deque.push(next)) {
+					expected.push_back(next);
+				}
+				next++;
+				break;
+			case 1:
+				if (deque.unshift(next)) {
+					expected.push_front(next);
+				}
+				next++;
+				break;
+			case 2:
+				CHECK(deque.tryPop(value) == !expected.empty());
+				if (!expected.empty()) {
+					CHECK(value == expected.back());
+					expected.pop_back();
+				}
+				break;
+			case 3:
+				CHECK(deque.tryShift(value) == !expected.empty());
+				if (!expected.empty()) {
+					CHECK(value == expected.front());
+					expected.pop_front();
+				}
+				break;
+			case 4: {
+				int values[3] = { next, next + 1, next + 2 };
+				next += 3;
+				const unsigned int pushed = deque.pushBulk(values, 3);
+				expected.insert(expected.end(), values, values + pushed);
+				break;
+			}
+			default:
+				if (!expected.empty()) {
+					const unsigned int index = rand() % expected.size();
+					deque[index] = next;
+					expected[index] = next++;
+				}
+				break;
+		}
+		checkSame(deque, expected);
+	}
+}
+
+// Bulk operations on a type with a destructor construct and destroy every element exactly once,
+// which the address sanitizer checks.
+static void testStrings() {
+	Deque<String, CAPACITY, countErrors> deque;
+	const String values[] = { "a", "b", "c", "d", "e", "f" };
+	for (unsigned int round = 0; round < 3 * CAPACITY; round++) {
+		CHECK(deque.pushBulk(values, 6) == 6);
+		String out[4];
+		CHECK(deque.shiftBulk(out, 4) == 4);
+		CHECK(out[0] == "a" && out[3] == "d");
+		CHECK(deque.size() == 2 && deque[0] == "e" && deque[1] == "f");
+		deque.consume(2);
+		CHECK(deque.isEmpty());
+	}
+	deque.pushBulk(values, 5);
+}
+
+int main() {
+	srand(1);
+	testWrapAround();
+	testRandom();
+	testStrings();
+	return failures;
+}
@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include "HashMap.h"
+#include "Test.h"
+
+// Looks up String keys through the const char*, F() and StringRef overloads; IGNORECASE tells
+// whether the comparer under test folds case.
+template<class H, bool IGNORECASE>
+static void testLookups() {
+	HashMap<String, int, 32, H> map;
+	map.add(String("topic/a"), 1);
+	map.add(String("topic/abc"), 2);
+	map.add(String("Mixed/Case"), 3);
+	const char buffer[] = "topic/abcdef";
+
+	CHECK(map.containsKey("topic/a"));
+	CHECK(map.containsKey("topic/abc"));
+	CHECK(!map.containsKey("topic/"));
+	CHECK(!map.containsKey("topic/ab"));
+	CHECK(!map.containsKey("topic/abcd"));
+	CHECK(map["topic/abc"] == 2);
+
+	CHECK(map.containsKey(F("topic/a")));
+	CHECK(map.containsKey(F("topic/abc")));
+	CHECK(!map.containsKey(F("topic/ab")));
+	CHECK(!map.containsKey(F("topic/abcd")));
+
+	// a StringRef into a longer buffer must only match its own length
+	CHECK(map.containsKey(StringRef(buffer, 7)));
+	CHECK(map.containsKey(StringRef(buffer, 9)));
+	CHECK(!map.containsKey(StringRef(buffer, 6)));
+	CHECK(!map.containsKey(StringRef(buffer, 8)));
+	CHECK(!map.containsKey(StringRef(buffer, 12)));
+	int value = 0;
+	CHECK(map.tryGet(StringRef(buffer, 9), value) && value == 2);
+
+	CHECK(map.containsKey("Mixed/Case"));
+	CHECK(map.containsKey("mixed/case") == IGNORECASE);
+	CHECK(map.containsKey(F("MIXED/CASE")) == IGNORECASE);
+	CHECK(map.containsKey(StringRef("mIxEd/cAsE!", 10)) == IGNORECASE);
+	CHECK(map.containsKey(String("TOPIC/A")) == IGNORECASE);
+	CHECK(!map.containsKey(StringRef("MIXED/CAS", 9)));
+
+	CHECK(map.remove(StringRef(buffer, 7)));
+	CHECK(!map.containsKey("topic/a"));
+	CHECK(map.containsKey("topic/abc"));
+}
+
+// Keys longer than 32 characters which share their first 32 characters.
+template<class H>
+static void testLongKeys() {
+	HashMap<String, int, 32, H> map;
+	map.add(String("building/north-wing/floor-1/room-1/temperature"), 1);
+	map.add(String("building/north-wing/floor-1/room-1/humidity"), 2);
+	CHECK(map["building/north-wing/floor-1/room-1/temperature"] == 1);
+	CHECK(map[F("building/north-wing/floor-1/room-1/humidity")] == 2);
+	CHECK(!map.containsKey("building/north-wing/floor-1/room-1/pressure"));
+}
+
+int main() {
+	testLookups<StringHashComparer, false>();
+	testLookups<StringIgnoreCaseHashComparer, true>();
+	testLookups<StringFullHashComparer<>, false>();
+	testLookups<StringFullHashComparer<0x9747B28CUL>, false>();
+	testLookups<StringIgnoreCaseFullHashComparer<>, true>();
+	testLongKeys<StringHashComparer>();
+	testLongKeys<StringFullHashComparer<>>();
+	testLongKeys<StringIgnoreCaseFullHashComparer<>>();
+	return failures;
+}
@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include "HashMap.h"
+#include "HashSet.h"
+#include "Test.h"
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <set>
+
+// Sends every key to one of seven buckets just before the end of the table, so that the clusters
+// wrap around from C - 1 to 0 and removal has to shift entries back across the wrap.
+template<unsigned int C>
+class WrappingHashComparer {
+public:
+	static unsigned int getHash(const uint32_t& value) {
+		return C - 3 + value % 7;
+	}
+	static bool equals(const uint32_t& x, const uint32_t& y) {
+		return x == y;
+	}
+};
+
+// Keeps the hashes below C, so that SwissProbing sees only a few fingerprints and a lookup
+// compares the key with a fixed share of the used slots it passes.
+template<unsigned int C>
+class CountingHashComparer {
+public:
+	static unsigned long comparisons;
+	static unsigned int getHash(const uint32_t& value) {
+		return value % C;
+	}
+	static bool equals(const uint32_t& x, const uint32_t& y) {
+		comparisons++;
+		return x == y;
+	}
+};
+
+template<unsigned int C>
+unsigned long CountingHashComparer<C>::comparisons = 0;
+
+template<unsigned int C, class H, template<typename, typename, unsigned int, class> class P>
+static void testMapChurn(const uint32_t keyRange, const unsigned int load) {
+	HashMap<uint32_t, String, C, H, IgnoreCollectionErrorHandler, P> map;
+	std::map<uint32_t, String> expected;
+	for (unsigned int round = 0; round < 20000; round++) {
+		const uint32_t key = rand() % keyRange;
+		if (expected.size() < load && rand() % 2 == 0) {
+			const String value(rand());
+			map.set(key, value);
+			expected[key] = value;
+		} else {
+			CHECK(map.remove(key) == (expected.erase(key) == 1));
+		}
+		CHECK(map.size() == expected.size());
+		if (round % 500 == 0) {
+			for (uint32_t k = 0; k < keyRange; k++) {
+				String value;
+				const std::map<uint32_t, String>::const_iterator found = expected.find(k);
+				CHECK(map.tryGet(k, value) == (found != expected.end()));
+				CHECK(found == expected.end() || value == found->second);
+			}
+			unsigned int count = 0;
+			for (auto pair : map) {
+				CHECK(expected.count(pair.key) == 1 && expected[pair.key] == pair.value);
+				count++;
+			}
+			CHECK(count == expected.size());
+		}
+	}
+	HashMap<uint32_t, String, C, H, IgnoreCollectionErrorHandler, P> copy(map);
+	for (const std::pair<const uint32_t, String>& entry : expected) {
+		CHECK(copy[entry.first] == entry.second);
+	}
+	map.clear();
+	CHECK(map.size() == 0 && !map.containsKey(expected.empty() ? 0 : expected.begin()->first));
+}
+
+template<unsigned int C, class H, template<typename, typename, unsigned int, class> class P>
+static void testSetChurn(const uint32_t keyRange, const unsigned int load) {
+	HashSet<uint32_t, C, H, IgnoreCollectionErrorHandler, P> set;
+	std::set<uint32_t> expected;
+	for (unsigned int round = 0; round < 20000; round++) {
+		const uint32_t key = rand() % keyRange;
+		if (expected.size() < load && rand() % 2 == 0) {
+			CHECK(set.add(key) == expected.insert(key).second);
+		} else {
+			CHECK(set.remove(key) == (expected.erase(key) == 1));
+		}
+		CHECK(set.size() == expected.size());
+		if (round % 500 == 0) {
+			for (uint32_t k = 0; k < keyRange; k++) {
+				CHECK(set[k] == (expected.count(k) == 1));
+			}
+		}
+	}
+}
+
+template<unsigned int C, template<typename, typename, unsigned int, class> class P>
+static void testStrategy() {
+	// random keys filling the table up to 95%
+	testMapChurn<C, GenericHashComparer<uint32_t>, P>(C * 2, C * 95 / 100);
+	testSetChurn<C, MixingHashComparer<GenericHashComparer<uint32_t>>, P>(C * 4, C * 95 / 100);
+	// one long cluster across the wrap, up to a full table
+	testMapChurn<C, WrappingHashComparer<C>, P>(C + C / 2, C);
+	testSetChurn<C, WrappingHashComparer<C>, P>(C + C / 2, C);
+}
+
+// Replaces the oldest key by a new one over and over, which leaves tombstones in every group
+// that fills up; the misses must still stop at a group with an empty slot instead of
+// comparing the key with every entry in the table.
+template<unsigned int C>
+static void testSwissMissCost() {
+	typedef CountingHashComparer<C> H;
+	HashSet<uint32_t, C, H, IgnoreCollectionErrorHandler, SwissProbing> set;
+	std::deque<uint32_t> keys;
+	uint32_t nextKey = 0;
+	for (unsigned int round = 0; round < 20000; round++) {
+		if (keys.size() >= C * 5 / 8) {
+			CHECK(set.remove(keys.front()));
+			keys.pop_front();
+		}
+		nextKey += 1 + rand() % C;
+		keys.push_back(nextKey);
+		CHECK(set.add(nextKey));
+		if (round % 100 == 0) {
+			H::comparisons = 0;
+			for (uint32_t key = nextKey + 1; key <= nextKey + C; key++) {
+				CHECK(!set[key]);
+			}
+			// a miss which scans every group compares the key with every sixteenth entry or more
+			CHECK(H::comparisons < C * keys.size() / 32);
+		}
+	}
+	CHECK(set.size() == keys.size());
+	for (uint32_t key : keys) {
+		CHECK(set[key]);
+	}
+}
+
+int main() {
+	srand(1);
+	testStrategy<256, LinearProbing>();
+	testStrategy<257, LinearProbing>();
+	testStrategy<256, CachedLinearProbing>();
+	testStrategy<257, CachedLinearProbing>();
+	testStrategy<256, RobinHoodProbing>();
+	testStrategy<257, RobinHoodProbing>();
+	testStrategy<256, CachedRobinHoodProbing>();
+	testStrategy<257, CachedRobinHoodProbing>();
+	testStrategy<256, SwissProbing>();
+	testStrategy<257, SwissProbing>();
+	testSwissMissCost<256>();
+	testSwissMissCost<257>();
+	return failures;
+}
@@ -0,0 +1,109 @@
+#include <Arduino.h>
+#include "MessageLoop.h"
+#include "Test.h"
+#include <thread>
+
+static int lastRun = 0;
+static unsigned int runs = 0;
+
+static unsigned int outOfSpace = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	}
+}
+
+static int record(int& value) {
+	lastRun = value;
+	runs++;
+	return 0;
+}
+
+static void testDeadlineOrder() {
+	MessageLoop<8> loop;
+	loop.post(record, 1, 10000);
+	loop.post(record, 2, 5000);
+	loop.post(record, 3);
+	loop.process();
+	CHECK(lastRun == 3);
+	CHECK(loop.timeUntilNext() > 4000 && loop.timeUntilNext() <= 5000);
+}
+
+static void testSleepBlocks() {
+	MessageLoop<8> loop;
+	CHECK(loop.timeUntilNext() == loop.NO_DEADLINE);
+	const unsigned long start = millis();
+	unsigned int calls = 0;
+	while (millis() - start < 200) {
+		loop.processOrSleep(50);
+		calls++;
+	}
+	CHECK(calls <= 5);
+}
+
+static void testPostWakesSleep() {
+	MessageLoop<8> loop;
+	runs = 0;
+	std::thread poster([&loop] {
+		delay(100);
+		loop.post(record, 4);
+	});
+	const unsigned long start = millis();
+	MessageLoop<8>::ProcessResult result = loop.processOrSleep();
+	const unsigned long slept = millis() - start;
+	poster.join();
+	CHECK(result.count == 1);
+	CHECK(runs == 1 && lastRun == 4);
+	CHECK(slept >= 90 && slept < 1000);
+}
+
+static void testSleepUntilDeadline() {
+	MessageLoop<8> loop;
+	loop.post(record, 5, 100);
+	const unsigned long start = millis();
+	MessageLoop<8>::ProcessResult result = loop.processOrSleep();
+	const unsigned long slept = millis() - start;
+	CHECK(result.count == 1 && lastRun == 5);
+	CHECK(slept >= 99 && slept < 1000);
+}
+
+static MessageLoop<4, countErrors>* fullLoop = nullptr;
+
+static int postFromCallback(int& value) {
+	fullLoop->post(record, value + 1);
+	return value == 6 ? 0 : 1000;
+}
+
+// The running message gives up its slot, so a callback can post into a full loop; a repeating
+// message which finds the loop full again afterwards is lost with an OutOfSpace error.
+static void testPostFromCallback() {
+	MessageLoop<4, countErrors> loop;
+	fullLoop = &loop;
+	outOfSpace = 0;
+	loop.post(postFromCallback, 6);
+	loop.post(record, 1, 10000);
+	loop.post(record, 2, 10000);
+	loop.post(record, 3, 10000);
+	loop.process();
+	CHECK(outOfSpace == 0);
+	runs = 0;
+	loop.process();
+	CHECK(runs == 1 && lastRun == 7);
+	loop.post(postFromCallback, 8);
+	loop.process();
+	CHECK(outOfSpace == 1);
+	loop.process();
+	CHECK(runs == 2 && lastRun == 9);
+	CHECK(loop.timeUntilNext() > 9000);
+	fullLoop = nullptr;
+}
+
+int main() {
+	testDeadlineOrder();
+	testSleepBlocks();
+	testPostWakesSleep();
+	testSleepUntilDeadline();
+	testPostFromCallback();
+	return failures;
+}
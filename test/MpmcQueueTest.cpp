@@ -0,0 +1,32 @@
+#include <Arduino.h>
+#include "MpmcQueue.h"
+#include "Test.h"
+
+static unsigned int outOfSpace = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	}
+}
+
+static void testPartialPushBulk() {
+	MpmcQueue<int, 4, countErrors> queue;
+	const int values[] = { 1, 2, 3, 4, 5, 6 };
+	CHECK(queue.tryPushBulk(values, 3) == 3);
+	CHECK(outOfSpace == 0);
+	CHECK(queue.tryPushBulk(values + 3, 3) == 1);
+	CHECK(outOfSpace == 1);
+	int out[4];
+	CHECK(queue.tryPopBulk(out, 4) == 4);
+	CHECK(out[0] == 1 && out[3] == 4);
+	CHECK(queue.tryPushBulk(values, 0) == 0);
+	CHECK(outOfSpace == 1);
+	CHECK(queue.tryPopBulk(out, 4) == 0);
+	CHECK(outOfSpace == 1);
+}
+
+int main() {
+	testPartialPushBulk();
+	return failures;
+}
@@ -0,0 +1,219 @@
+#include <Arduino.h>
+#include "PriorityQueue.h"
+#include "Test.h"
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <utility>
+
+static const unsigned int CAPACITY = 64;
+
+// The id tells equal keys apart, so that the model knows which element the queue popped.
+struct Item {
+	int key;
+	unsigned int id;
+};
+
+static int compareItems(const Item& x, const Item& y) {
+	return GenericComparer(x.key, y.key);
+}
+
+static unsigned int outOfSpace = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	}
+}
+
+template<unsigned int D>
+class Model {
+public:
+	typedef PriorityQueue<Item, CAPACITY, compareItems, D, countErrors> Queue;
+	Queue queue;
+	std::multiset<std::pair<int, unsigned int>> items;
+	std::map<unsigned int, typename Queue::Handle> handles;
+	unsigned int nextId = 0;
+
+	Item next() {
+		const Item item = { rand() % 100, nextId++ };
+		return item;
+	}
+
+	void add(const Item& item, const typename Queue::Handle handle) {
+		CHECK(handle < CAPACITY);
+		for (const std::pair<const unsigned int, typename Queue::Handle>& entry : handles) {
+			CHECK(entry.second != handle);
+		}
+		items.insert(std::make_pair(item.key, item.id));
+		handles[item.id] = handle;
+	}
+
+	void forget(const unsigned int id, const int key) {
+		items.erase(items.find(std::make_pair(key, id)));
+		handles.erase(id);
+	}
+
+	// A random live element, picked through its handle
+	bool pick(unsigned int& id, typename Queue::Handle& handle) {
+		if (handles.empty()) {
+			return false;
+		}
+		typename std::map<unsigned int, typename Queue::Handle>::const_iterator it = handles.begin();
+		std::advance(it, rand() % handles.size());
+		id = it->first;
+		handle = it->second;
+		return true;
+	}
+
+	void check() {
+		CHECK(queue.size() == items.size());
+		CHECK(queue.isEmpty() == items.empty());
+		CHECK(queue.isFull() == (items.size() == CAPACITY));
+		// every handle still addresses the element it was returned for
+		for (const std::pair<const unsigned int, typename Queue::Handle>& entry : handles) {
+			CHECK(queue.contains(entry.second));
+			CHECK(queue[entry.second].id == entry.first);
+		}
+		if (!items.empty()) {
+			CHECK(queue.peek().key == items.begin()->first);
+			CHECK(queue[queue.peekHandle()].key == items.begin()->first);
+		} else {
+			CHECK(queue.peekHandle() == Queue::NO_HANDLE);
+		}
+	}
+};
+
+// Runs random operations against a std::multiset and checks the order and the handles after each.
+template<unsigned int D>
+static void testRandom() {
+	Model<D> model;
+	outOfSpace = 0;
+	unsigned int expectedOutOfSpace = 0;
+	for (unsigned int round = 0; round < 20000; round++) {
+		unsigned int id;
+		typename Model<D>::Queue::Handle handle;
+		switch (rand() % 8) {
+			case 0:
+			case 1: {
+				const Item item = model.next();
+				handle = model.queue.push(item);
+				if (model.items.size() == CAPACITY) {
+					CHECK(handle == Model<D>::Queue::NO_HANDLE);
+					expectedOutOfSpace++;
+				} else {
+					model.add(item, handle);
+				}
+				break;
+			}
+			case 2: {
+				Item values[CAPACITY];
+				const unsigned int count = 1 + rand() % (rand() % 4 == 0 ? CAPACITY : 4);
+				for (unsigned int i = 0; i < count; i++) {
+					values[i] = model.next();
+				}
+				const unsigned int room = CAPACITY - model.items.size();
+				const unsigned int added = model.queue.pushBulk(values, count);
+				CHECK(added == (count < room ? count : room));
+				if (added < count) {
+					expectedOutOfSpace++;
+				}
+				// pushBulk returns no handles, so they are looked up by id
+				for (typename Model<D>::Queue::Handle h = 0; h < CAPACITY; h++) {
+					if (model.queue.contains(h) && model.handles.count(model.queue[h].id) == 0) {
+						const Item& item = model.queue[h];
+						CHECK(item.id >= values[0].id && item.id < values[0].id + added);
+						CHECK(item.key == values[item.id - values[0].id].key);
+						model.add(item, h);
+					}
+				}
+				break;
+			}
+			case 3: {
+				Item item;
+				const bool popped = model.queue.tryPop(item);
+				CHECK(popped == !model.items.empty());
+				if (popped) {
+					CHECK(item.key == model.items.begin()->first);
+					model.forget(item.id, item.key);
+				}
+				break;
+			}
+			case 4:
+				if (model.pick(id, handle)) {
+					const Item item = model.queue[handle];
+					const Item lower = { item.key - rand() % 20, id };
+					model.queue.decreaseKey(handle, lower);
+					model.forget(id, item.key);
+					model.add(lower, handle);
+				}
+				break;
+			case 5:
+				if (model.pick(id, handle)) {
+					const Item item = model.queue[handle];
+					const Item changed = { rand() % 100, id };
+					model.queue.update(handle, changed);
+					model.forget(id, item.key);
+					model.add(changed, handle);
+				}
+				break;
+			case 6:
+				if (model.pick(id, handle)) {
+					const int key = model.queue[handle].key;
+					model.queue.remove(handle);
+					CHECK(!model.queue.contains(handle));
+					model.forget(id, key);
+				}
+				break;
+			default:
+				if (rand() % 100 == 0) {
+					model.queue.clear();
+					model.items.clear();
+					model.handles.clear();
+				}
+				break;
+		}
+		model.check();
+		if (round % 500 == 0) {
+			// a copy keeps the handles and pops everything in order
+			typename Model<D>::Queue copy(model.queue);
+			for (const std::pair<const unsigned int, typename Model<D>::Queue::Handle>& entry : model.handles) {
+				CHECK(copy[entry.second].id == entry.first);
+			}
+			for (const std::pair<int, unsigned int>& item : model.items) {
+				CHECK(copy.pop().key == item.first);
+			}
+			CHECK(copy.isEmpty());
+		}
+	}
+	CHECK(outOfSpace == expectedOutOfSpace);
+}
+
+template<unsigned int D>
+static void testHeapify() {
+	for (unsigned int round = 0; round < 200; round++) {
+		int values[100];
+		const unsigned int size = rand() % 101;
+		int minimum = 100;
+		for (unsigned int i = 0; i < size; i++) {
+			values[i] = rand() % 100;
+			minimum = values[i] < minimum ? values[i] : minimum;
+		}
+		std::multiset<int> expected(values, values + size);
+		PriorityQueue<int, 1, GenericComparer<int>, D>::heapify(values, size);
+		CHECK(std::multiset<int>(values, values + size) == expected);
+		CHECK(size == 0 || values[0] == minimum);
+		for (unsigned int i = 1; i < size; i++) {
+			CHECK(values[(i - 1) / D] <= values[i]);
+		}
+	}
+}
+
+int main() {
+	srand(1);
+	testRandom<2>();
+	testRandom<4>();
+	testHeapify<2>();
+	testHeapify<4>();
+	return failures;
+}
@@ -0,0 +1,90 @@
+#include <Arduino.h>
+#include "SlidingWindow.h"
+#include "Test.h"
+#include <cmath>
+#include <cstdlib>
+
+template<typename T>
+static void exact(const T* values, const unsigned int n, double& mean, double& variance) {
+	double sum = 0;
+	for (unsigned int i = 0; i < n; i++) {
+		sum += values[i];
+	}
+	mean = sum / n;
+	variance = 0;
+	for (unsigned int i = 0; i < n; i++) {
+		variance += (values[i] - mean) * (values[i] - mean);
+	}
+	variance /= n;
+}
+
+static void testAggregates() {
+	SlidingWindow<int, 8> window;
+	int values[8];
+	for (int i = 0; i < 100; i++) {
+		const int value = (i * 37) % 23 - 11;
+		window.push(value, i);
+		const unsigned int n = window.size();
+		int min = window[0];
+		int max = window[0];
+		for (unsigned int j = 0; j < n; j++) {
+			values[j] = window[j];
+			min = std::min(min, values[j]);
+			max = std::max(max, values[j]);
+		}
+		double mean;
+		double variance;
+		exact(values, n, mean, variance);
+		CHECK(window[n - 1] == value);
+		CHECK(window.min() == min);
+		CHECK(window.max() == max);
+		CHECK(std::fabs(window.mean() - mean) < 1e-9);
+		CHECK(std::fabs(window.sum() - mean * n) < 1e-9);
+		CHECK(std::fabs(window.variance() - variance) < 1e-9);
+	}
+	window.evictBefore(97);
+	CHECK(window.size() == 3);
+	CHECK(window.timeOf(0) == 97);
+}
+
+// Values of 1000 +/- 0.1 summed into a float window: the sum of squares approach lost all precision.
+static void testFloatPrecision() {
+	SlidingWindow<float, 32, float> window;
+	float values[32];
+	srand(1);
+	for (unsigned long i = 0; i < 2000000; i++) {
+		window.push(1000.0f + ((rand() % 2001) - 1000) / 10000.0f);
+	}
+	for (unsigned int i = 0; i < 32; i++) {
+		values[i] = window[i];
+	}
+	double mean;
+	double variance;
+	exact(values, 32, mean, variance);
+	CHECK(std::fabs(window.mean() - mean) < 1e-4);
+	CHECK(std::fabs(window.variance() - variance) < variance * 0.01);
+}
+
+static void testDoublePrecision() {
+	SlidingWindow<double, 32> window;
+	double values[32];
+	srand(2);
+	for (unsigned long i = 0; i < 2000000; i++) {
+		window.push(100000.0 + (rand() % 1000) / 100.0);
+	}
+	for (unsigned int i = 0; i < 32; i++) {
+		values[i] = window[i];
+	}
+	double mean;
+	double variance;
+	exact(values, 32, mean, variance);
+	CHECK(std::fabs(window.mean() - mean) < 1e-9);
+	CHECK(std::fabs(window.variance() - variance) < variance * 1e-9);
+}
+
+int main() {
+	testAggregates();
+	testFloatPrecision();
+	testDoublePrecision();
+	return failures;
+}
@@ -0,0 +1,30 @@
+#include <Arduino.h>
+#include "SpscRing.h"
+#include "Test.h"
+
+static unsigned int outOfSpace = 0;
+
+static void countErrors(CollectionError error) {
+	if (error == CollectionError::OutOfSpace) {
+		outOfSpace++;
+	}
+}
+
+static void testPartialPushBulk() {
+	SpscRing<int, 4, countErrors> ring;
+	const int values[] = { 1, 2, 3, 4, 5, 6 };
+	CHECK(ring.pushBulk(values, 3) == 3);
+	CHECK(outOfSpace == 0);
+	CHECK(ring.pushBulk(values + 3, 3) == 1);
+	CHECK(outOfSpace == 1);
+	int out[4];
+	CHECK(ring.shiftBulk(out, 4) == 4);
+	CHECK(out[0] == 1 && out[3] == 4);
+	CHECK(ring.pushBulk(values, 0) == 0);
+	CHECK(outOfSpace == 1);
+}
+
+int main() {
+	testPartialPushBulk();
+	return failures;
+}
@@ -0,0 +1,17 @@
+#ifndef _Test_H
+#define _Test_H
+
+#include <cstdio>
+
+// Counts and reports failed checks; every test program returns the number of failures from main().
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			failures++; \
+		} \
+	} while (false)
+
+#endif
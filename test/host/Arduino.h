@@ -0,0 +1,90 @@
+// Minimal stand-in for the Arduino core, so that the collections can be compiled and tested on a
+// host with a regular C++ compiler. Only what the library uses is provided.
+
+#ifndef _Arduino_H
+#define _Arduino_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <strings.h>
+#include <thread>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PGM_P const char*
+#define PSTR(s) (s)
+
+inline uint8_t pgm_read_byte(const void* p) {
+	return *(const uint8_t*)p;
+}
+
+inline void* memcpy_P(void* destination, const void* source, size_t size) {
+	return memcpy(destination, source, size);
+}
+
+inline size_t strlen_P(const char* s) {
+	return strlen(s);
+}
+
+inline int strcmp_P(const char* x, const char* y) {
+	return strcmp(x, y);
+}
+
+inline int strcasecmp_P(const char* x, const char* y) {
+	return strcasecmp(x, y);
+}
+
+class String {
+public:
+	String() {}
+	String(const char* s): _s(s) {}
+	String(int value): _s(std::to_string(value)) {}
+	String(unsigned int value): _s(std::to_string(value)) {}
+	unsigned int length() const { return _s.size(); }
+	char charAt(unsigned int index) const { return _s[index]; }
+	const char* c_str() const { return _s.c_str(); }
+	bool equals(const String& other) const { return _s == other._s; }
+	bool equals(const char* other) const { return _s == other; }
+	bool equalsIgnoreCase(const String& other) const { return _s.size() == other._s.size() && strncasecmp(_s.c_str(), other._s.c_str(), _s.size()) == 0; }
+	bool operator==(const String& other) const { return _s == other._s; }
+	bool operator!=(const String& other) const { return _s != other._s; }
+	bool operator<(const String& other) const { return _s < other._s; }
+	bool operator>(const String& other) const { return _s > other._s; }
+	String& operator+=(const String& other) { _s += other._s; return *this; }
+	String operator+(const String& other) const { String result(*this); result += other; return result; }
+private:
+	std::string _s;
+};
+
+class HostSerial {
+public:
+	void begin(unsigned long baud) {}
+	void print(const char* s) { fputs(s, stdout); }
+	void print(const String& s) { fputs(s.c_str(), stdout); }
+	void println(const char* s) { puts(s); }
+	void println() { putchar('\n'); }
+};
+
+static HostSerial Serial;
+
+inline unsigned long millis() {
+	return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long micros() {
+	return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void delay(unsigned long ms) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {
+	std::this_thread::yield();
+}
+
+#endif